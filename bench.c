@@ -0,0 +1,433 @@
+/*
+ * 等待路径性能测试
+ * 创建N对socketpair/pipe，每轮让其中一部分可读，测量PollerWaitEvent()的耗时、事件吞吐和每个事件的CPU时间
+ * -d时改为测量后端分派的开销：PollerRearmEvent()与直接调用后端函数的耗时之差
+ * 结果以CSV输出到标准输出，提示信息输出到标准错误
+ * 用法：./bench [-b epoll,poll,select,uring] [-n 1,100,10000] [-a 0.01] [-i 轮数] [-p] [-s] [-d]
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include "easy_poller.h"
+#include "epoll_poller.h"
+#include "poll_poller.h"
+#include "select_poller.h"
+#include "uring_poller.h"
+
+#define BENCH_MAX_EVENTS 1024 /* 每次等待最多取的事件个数 */
+#define BENCH_MAX_COUNTS 32 /* -n最多的个数 */
+#define BENCH_DISPATCH_CALLS 10000000 /* -d默认的调用次数 */
+#define BENCH_DISPATCH_FD 1000 /* -d使用的未注册fd，后端不产生系统调用 */
+
+/*
+ * 测试参数
+ */
+typedef struct BenchOptions_t
+{
+	int types[4]; /* 要测试的Poller类型 */
+	int typeCount;
+	int counts[BENCH_MAX_COUNTS]; /* fd对数 */
+	int countNums;
+	double active; /* 每轮可读的比例 */
+	int iterations; /* 轮数，0表示按fd数自动选择 */
+	int usePipe; /* 使用pipe代替socketpair */
+	int flags; /* 额外的Poller创建标志 */
+	int dispatch; /* 测量分派开销 */
+}BenchOptions_t;
+
+/*
+ * 一组测试的结果
+ */
+typedef struct BenchResult_t
+{
+	int iterations;
+	long long events; /* 收到的事件总数 */
+	long long waitNs; /* 等待的总耗时 */
+	long long cpuNs; /* 等待的总CPU时间 */
+	long long p50, p99, max; /* 每轮等待耗时的分位数 */
+}BenchResult_t;
+
+static const char *BenchTypeName(int type)
+{
+	switch (type)
+	{
+	case PT_EPOLLER: return "epoll";
+	case PT_POLLER: return "poll";
+	case PT_SELECTOR: return "select";
+	case PT_URING: return "uring";
+	}
+	return "unknown";
+}
+
+static long long BenchClock(clockid_t id)
+{
+	struct timespec ts;
+	clock_gettime(id, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int BenchCompare(const void *a, const void *b)
+{
+	long long x = *(const long long *)a, y = *(const long long *)b;
+	return (x > y) - (x < y);
+}
+
+/*
+ * 解析参数
+ * return：0 on success，-1 on fail
+ */
+static int BenchParse(int argc, char **argv, BenchOptions_t *opt)
+{
+	static const int defaultCounts[] = {1, 10, 100, 1000, 10000, 100000};
+	char *list = NULL, *token = NULL, *save = NULL;
+	int c = 0, i = 0;
+
+	memset(opt, 0, sizeof(BenchOptions_t));
+	opt->types[0] = PT_EPOLLER;
+	opt->types[1] = PT_POLLER;
+	opt->types[2] = PT_SELECTOR;
+	opt->typeCount = 3;
+	for (i = 0; i < (int)(sizeof(defaultCounts) / sizeof(defaultCounts[0])); i++)
+		opt->counts[opt->countNums++] = defaultCounts[i];
+	opt->active = 0.01;
+
+	while ((c = getopt(argc, argv, "b:n:a:i:psdh")) != -1)
+	{
+		switch (c)
+		{
+		case 'b':
+			opt->typeCount = 0;
+			for (list = optarg; (token = strtok_r(list, ",", &save)) != NULL && opt->typeCount < 4; list = NULL)
+			{
+				if (!strcmp(token, "epoll")) opt->types[opt->typeCount++] = PT_EPOLLER;
+				else if (!strcmp(token, "poll")) opt->types[opt->typeCount++] = PT_POLLER;
+				else if (!strcmp(token, "select")) opt->types[opt->typeCount++] = PT_SELECTOR;
+				else if (!strcmp(token, "uring")) opt->types[opt->typeCount++] = PT_URING;
+				else return -1;
+			}
+			break;
+
+		case 'n':
+			opt->countNums = 0;
+			for (list = optarg; (token = strtok_r(list, ",", &save)) != NULL && opt->countNums < BENCH_MAX_COUNTS; list = NULL)
+			{
+				if (atoi(token) < 1)
+					return -1;
+				opt->counts[opt->countNums++] = atoi(token);
+			}
+			break;
+
+		case 'a':
+			opt->active = atof(optarg);
+			if (opt->active <= 0 || opt->active > 1)
+				return -1;
+			break;
+
+		case 'i':
+			opt->iterations = atoi(optarg);
+			break;
+
+		case 'p':
+			opt->usePipe = 1;
+			break;
+
+		case 's': /* 统计阻塞时间，用于测量计时本身的开销 */
+			opt->flags |= POLLER_FLAG_STATS_TIME;
+			break;
+
+		case 'd':
+			opt->dispatch = 1;
+			break;
+
+		default:
+			return -1;
+		}
+	}
+
+	return (opt->typeCount > 0 && opt->countNums > 0) ? 0 : -1;
+}
+
+/*
+ * 运行一组测试
+ * fds：count对fd，fds[i * 2]为读端，fds[i * 2 + 1]为写端
+ * return：0 on success，-1 on fail
+ */
+static int BenchRun(int type, int flags, const int *fds, int count, int active, int iterations, BenchResult_t *result)
+{
+	static EasyEvent_t events[BENCH_MAX_EVENTS];
+	PollerOptions_t options;
+	long long start = 0, cpu = 0, elapsed = 0;
+	int i = 0, j = 0, k = 0, got = 0, ret = 0, next = 0;
+	char buf[16];
+
+	memset(result, 0, sizeof(BenchResult_t));
+
+	options.size = count;
+	options.flags = POLLER_FLAG_NOLOCK | flags;
+	PollerHandle handle = PollerCreateEx(type, &options);
+	if (!handle)
+		return -1;
+
+	EasyEvent_t *regs = (EasyEvent_t *)malloc(count * sizeof(EasyEvent_t));
+	long long *samples = (long long *)malloc(iterations * sizeof(long long));
+	if (!regs || !samples)
+		goto fail;
+
+	for (i = 0; i < count; i++)
+	{
+		regs[i].fd = fds[i * 2];
+		regs[i].event = EVENT_READ;
+		regs[i].retEvent = 0;
+		regs[i].userData = (void *)(long)i;
+	}
+	if (PollerAddEvents(handle, regs, count, NULL) != count)
+		goto fail;
+
+	for (i = 0; i < iterations; i++)
+	{
+		/* 每轮换一批fd可读，分散在整个范围内 */
+		for (j = 0; j < active; j++)
+		{
+			k = (int)(((long long)j * count / active + i) % count);
+			if (write(fds[k * 2 + 1], "x", 1) != 1)
+				goto fail;
+		}
+
+		/* 只统计等待本身，读数据不计入 */
+		elapsed = 0;
+		for (got = 0; got < active; got += ret)
+		{
+			start = BenchClock(CLOCK_MONOTONIC);
+			cpu = BenchClock(CLOCK_THREAD_CPUTIME_ID);
+			ret = PollerWaitEvent(handle, events, BENCH_MAX_EVENTS, 1000);
+			result->cpuNs += BenchClock(CLOCK_THREAD_CPUTIME_ID) - cpu;
+			elapsed += BenchClock(CLOCK_MONOTONIC) - start;
+
+			if (ret <= 0) /* 1秒内没有收到写入的数据 */
+				goto fail;
+
+			for (j = 0; j < ret; j++)
+			{
+				next = (int)(long)events[j].userData;
+				if (read(fds[next * 2], buf, sizeof(buf)) <= 0)
+					goto fail;
+			}
+		}
+
+		samples[i] = elapsed;
+		result->waitNs += elapsed;
+		result->events += got;
+	}
+
+	qsort(samples, iterations, sizeof(long long), BenchCompare);
+	result->iterations = iterations;
+	result->p50 = samples[iterations / 2];
+	result->p99 = samples[(int)((iterations - 1) * 0.99)];
+	result->max = samples[iterations - 1];
+
+	free(samples);
+	free(regs);
+	PollerDestroy(handle);
+	return 0;
+
+fail:
+	if (samples)
+		free(samples);
+	if (regs)
+		free(regs);
+	PollerDestroy(handle);
+	return -1;
+}
+
+/*
+ * 测量一种后端的分派开销：同一个未注册fd分别经PollerRearmEvent()和后端函数重新激活
+ * 定义EASY_POLLER_PIN_EPOLL编译时只有epoll能创建
+ * return：0 on success，-1 on fail
+ */
+static int BenchDispatch(int type, int calls)
+{
+	PollerOptions_t options;
+	EasyEvent_t event;
+	long long start = 0, poller = 0, direct = 0;
+	void *backend = NULL;
+	int i = 0;
+
+	options.size = 64;
+	options.flags = POLLER_FLAG_NOLOCK;
+	memset(&event, 0, sizeof(event));
+	event.fd = BENCH_DISPATCH_FD;
+
+	PollerHandle handle = PollerCreateEx(type, &options);
+	if (!handle)
+		return -1;
+
+	switch (type)
+	{
+	case PT_EPOLLER: backend = EpollCreateEx(&options); break;
+	case PT_POLLER: backend = PollCreateEx(&options); break;
+	case PT_SELECTOR: backend = SelectCreateEx(&options); break;
+	case PT_URING: backend = UringCreateEx(&options); break;
+	}
+	if (!backend)
+	{
+		PollerDestroy(handle);
+		return -1;
+	}
+
+	start = BenchClock(CLOCK_MONOTONIC);
+	for (i = 0; i < calls; i++)
+		PollerRearmEvent(handle, &event);
+	poller = BenchClock(CLOCK_MONOTONIC) - start;
+
+	start = BenchClock(CLOCK_MONOTONIC);
+	switch (type)
+	{
+	case PT_EPOLLER: for (i = 0; i < calls; i++) EpollRearmEvent(backend, &event); break;
+	case PT_POLLER: for (i = 0; i < calls; i++) PollRearmEvent(backend, &event); break;
+	case PT_SELECTOR: for (i = 0; i < calls; i++) SelectRearmEvent(backend, &event); break;
+	case PT_URING: for (i = 0; i < calls; i++) UringRearmEvent(backend, &event); break;
+	}
+	direct = BenchClock(CLOCK_MONOTONIC) - start;
+
+	printf("%s,%d,%.2f,%.2f,%.2f\n", BenchTypeName(type), calls,
+		(double)poller / calls, (double)direct / calls, (double)(poller - direct) / calls);
+	fflush(stdout);
+
+	switch (type)
+	{
+	case PT_EPOLLER: EpollDestroy(backend); break;
+	case PT_POLLER: PollDestroy(backend); break;
+	case PT_SELECTOR: SelectDestroy(backend); break;
+	case PT_URING: UringDestroy(backend); break;
+	}
+	PollerDestroy(handle);
+	return 0;
+}
+
+/*
+ * 创建count对fd，返回的数组需要释放
+ * return：fd数组，失败返回NULL
+ */
+static int *BenchOpen(int count, int usePipe)
+{
+	int *fds = (int *)malloc(count * 2 * sizeof(int));
+	int i = 0, ret = 0;
+	if (!fds)
+		return NULL;
+
+	for (i = 0; i < count; i++)
+	{
+		if (usePipe)
+			ret = pipe2(&fds[i * 2], O_NONBLOCK | O_CLOEXEC);
+		else
+			ret = socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, &fds[i * 2]);
+
+		if (ret < 0)
+		{
+			while (--i >= 0)
+			{
+				close(fds[i * 2]);
+				close(fds[i * 2 + 1]);
+			}
+			free(fds);
+			return NULL;
+		}
+	}
+
+	return fds;
+}
+
+static void BenchClose(int *fds, int count)
+{
+	int i = 0;
+	for (; i < count * 2; i++)
+		close(fds[i]);
+	free(fds);
+}
+
+int main(int argc, char **argv)
+{
+	BenchOptions_t opt;
+	BenchResult_t result;
+	struct rlimit limit;
+	int i = 0, t = 0, count = 0, active = 0, iterations = 0;
+
+	if (BenchParse(argc, argv, &opt) < 0)
+	{
+		fprintf(stderr, "usage: %s [-b epoll,poll,select,uring] [-n 1,100,10000] [-a active_ratio] [-i iterations] [-p(pipe)] [-s(stats time)] [-d(dispatch)]\n", argv[0]);
+		return 1;
+	}
+
+	if (opt.dispatch)
+	{
+		printf("backend,calls,poller_ns,direct_ns,dispatch_ns\n");
+		for (t = 0; t < opt.typeCount; t++)
+		{
+			if (BenchDispatch(opt.types[t], opt.iterations > 0 ? opt.iterations : BENCH_DISPATCH_CALLS) < 0)
+				fprintf(stderr, "skip %s: create failed\n", BenchTypeName(opt.types[t]));
+		}
+		return 0;
+	}
+
+	/* fd数量按最大的一组提高上限 */
+	getrlimit(RLIMIT_NOFILE, &limit);
+	limit.rlim_cur = limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+
+	printf("backend,fds,active,iterations,wait_avg_ns,wait_p50_ns,wait_p99_ns,wait_max_ns,events_per_sec,cpu_ns_per_event\n");
+
+	for (i = 0; i < opt.countNums; i++)
+	{
+		count = opt.counts[i];
+		active = (int)(count * opt.active + 0.5);
+		if (active < 1)
+			active = 1;
+
+		iterations = opt.iterations;
+		if (iterations <= 0) /* fd越多单轮越慢，轮数相应减少 */
+			iterations = (count >= 10000) ? 200 : (count >= 1000 ? 2000 : 20000);
+
+		if ((rlim_t)count * 2 + 64 > limit.rlim_cur)
+		{
+			fprintf(stderr, "skip fds=%d: RLIMIT_NOFILE=%ld\n", count, (long)limit.rlim_cur);
+			continue;
+		}
+
+		int *fds = BenchOpen(count, opt.usePipe);
+		if (!fds)
+		{
+			fprintf(stderr, "skip fds=%d: create %s failed\n", count, opt.usePipe ? "pipe" : "socketpair");
+			continue;
+		}
+
+		for (t = 0; t < opt.typeCount; t++)
+		{
+			if (BenchRun(opt.types[t], opt.flags, fds, count, active, iterations, &result) < 0)
+			{
+				fprintf(stderr, "skip %s fds=%d: run failed\n", BenchTypeName(opt.types[t]), count);
+				continue;
+			}
+
+			printf("%s,%d,%d,%d,%lld,%lld,%lld,%lld,%.0f,%.1f\n",
+				BenchTypeName(opt.types[t]), count, active, result.iterations,
+				result.waitNs / result.iterations, result.p50, result.p99, result.max,
+				result.events * 1e9 / (result.waitNs ? result.waitNs : 1),
+				(double)result.cpuNs / result.events);
+			fflush(stdout);
+		}
+
+		BenchClose(fds, count);
+	}
+
+	return 0;
+}
+
@@ -0,0 +1,217 @@
+/*
+ * 环形缓冲区实现
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "easy_buffer.h"
+
+#define BUFFER_MIN_SIZE 256 /* 最小容量 */
+#define BUFFER_MAX_SIZE (1U << 31) /* 最大容量，读写位置差不能溢出 */
+
+/*
+ * 初始化
+ * size：初始容量，向上取2的幂，<=0时首次写入时分配
+ * return：0 on success，-1 on fail
+ */
+int BufferInit(EasyBuffer_t *buf, int size)
+{
+	buf->data = NULL;
+	buf->size = 0;
+	buf->head = 0;
+	buf->tail = 0;
+
+	if (size <= 0)
+		return 0;
+	return BufferReserve(buf, (unsigned int)size);
+}
+
+/*
+ * 释放
+ */
+void BufferDestroy(EasyBuffer_t *buf)
+{
+	if (buf->data)
+		free(buf->data);
+	buf->data = NULL;
+	buf->size = 0;
+	buf->head = 0;
+	buf->tail = 0;
+}
+
+/*
+ * 保证至少还能写入len字节，不够时扩容
+ * 扩容时把数据整理到新缓冲区的开头
+ * return：0 on success，-1 on fail
+ */
+int BufferReserve(EasyBuffer_t *buf, unsigned int len)
+{
+	unsigned int used = BufferLength(buf);
+	if (buf->size - used >= len)
+		return 0;
+
+	if (len > BUFFER_MAX_SIZE - used)
+		return -1;
+
+	unsigned int size = buf->size ? buf->size : BUFFER_MIN_SIZE;
+	while (size - used < len)
+		size <<= 1;
+
+	char *data = (char *)malloc(size);
+	if (!data)
+		return -1;
+
+	BufferRead(buf, data, used);
+	if (buf->data)
+		free(buf->data);
+
+	buf->data = data;
+	buf->size = size;
+	buf->head = 0;
+	buf->tail = used;
+	return 0;
+}
+
+/*
+ * 追加数据，空间不够时扩容
+ * return：0 on success，-1 on fail
+ */
+int BufferAppend(EasyBuffer_t *buf, const void *data, unsigned int len)
+{
+	if (len == 0)
+		return 0;
+
+	if (BufferReserve(buf, len) < 0)
+		return -1;
+
+	unsigned int pos = buf->tail & (buf->size - 1);
+	unsigned int first = buf->size - pos;
+	if (first > len)
+		first = len;
+
+	memcpy(buf->data + pos, data, first);
+	memcpy(buf->data, (const char *)data + first, len - first);
+	buf->tail += len;
+	return 0;
+}
+
+/*
+ * 取出数据
+ * return：取出的字节数
+ */
+unsigned int BufferRead(EasyBuffer_t *buf, void *data, unsigned int len)
+{
+	unsigned int used = BufferLength(buf);
+	if (len > used)
+		len = used;
+	if (len == 0)
+		return 0;
+
+	unsigned int pos = buf->head & (buf->size - 1);
+	unsigned int first = buf->size - pos;
+	if (first > len)
+		first = len;
+
+	memcpy(data, buf->data + pos, first);
+	memcpy((char *)data + first, buf->data, len - first);
+	buf->head += len;
+
+	if (buf->head == buf->tail) /* 读空后从头开始，下次写入尽量不绕回 */
+		buf->head = buf->tail = 0;
+	return len;
+}
+
+/*
+ * 第一段连续数据，不取出
+ * len：保存该段长度
+ * return：数据地址，没有数据时返回NULL
+ */
+const void *BufferPeek(const EasyBuffer_t *buf, unsigned int *len)
+{
+	unsigned int used = BufferLength(buf);
+	if (used == 0)
+	{
+		*len = 0;
+		return NULL;
+	}
+
+	unsigned int pos = buf->head & (buf->size - 1);
+	*len = (buf->size - pos < used) ? (buf->size - pos) : used;
+	return buf->data + pos;
+}
+
+/*
+ * 丢弃前len字节
+ */
+void BufferConsume(EasyBuffer_t *buf, unsigned int len)
+{
+	unsigned int used = BufferLength(buf);
+	buf->head += (len > used) ? used : len;
+
+	if (buf->head == buf->tail) /* 读空后从头开始，下次写入尽量不绕回 */
+		buf->head = buf->tail = 0;
+}
+
+/*
+ * 数据对应的iovec，用于writev
+ * iov：至少2个元素
+ * return：iovec个数(0~2)
+ */
+int BufferDataIov(const EasyBuffer_t *buf, struct iovec *iov)
+{
+	unsigned int used = BufferLength(buf);
+	if (used == 0)
+		return 0;
+
+	unsigned int pos = buf->head & (buf->size - 1);
+	unsigned int first = buf->size - pos;
+
+	iov[0].iov_base = buf->data + pos;
+	if (first >= used)
+	{
+		iov[0].iov_len = used;
+		return 1;
+	}
+
+	iov[0].iov_len = first;
+	iov[1].iov_base = buf->data;
+	iov[1].iov_len = used - first;
+	return 2;
+}
+
+/*
+ * 空闲空间对应的iovec，用于readv，读入后调用BufferCommit()
+ * iov：至少2个元素
+ * return：iovec个数(0~2)
+ */
+int BufferSpaceIov(const EasyBuffer_t *buf, struct iovec *iov)
+{
+	unsigned int space = buf->size - BufferLength(buf);
+	if (space == 0)
+		return 0;
+
+	unsigned int pos = buf->tail & (buf->size - 1);
+	unsigned int first = buf->size - pos;
+
+	iov[0].iov_base = buf->data + pos;
+	if (first >= space)
+	{
+		iov[0].iov_len = space;
+		return 1;
+	}
+
+	iov[0].iov_len = first;
+	iov[1].iov_base = buf->data;
+	iov[1].iov_len = space - first;
+	return 2;
+}
+
+/*
+ * 确认直接写入空闲空间的len字节
+ */
+void BufferCommit(EasyBuffer_t *buf, unsigned int len)
+{
+	buf->tail += len;
+}
@@ -0,0 +1,103 @@
+/*
+ * 环形缓冲区声明
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_BUFFER_H__
+#define __FREE_EASY_BUFFER_H__
+#include <sys/uio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 环形缓冲区，容量为2的幂，读写位置只增不减，取模得到下标
+ * 数据最多分成两段，正好对应readv/writev的两个iovec；空间不够时扩容并整理成一段
+ * 不加锁，由调用者保证互斥
+ */
+typedef struct EasyBuffer_t
+{
+	char *data;
+	unsigned int size; /* 容量，2的幂 */
+	unsigned int head; /* 读位置 */
+	unsigned int tail; /* 写位置 */
+}EasyBuffer_t;
+
+/*
+ * 初始化
+ * size：初始容量，向上取2的幂，<=0时首次写入时分配
+ * return：0 on success，-1 on fail
+ */
+int BufferInit(EasyBuffer_t *buf, int size);
+
+/*
+ * 释放
+ */
+void BufferDestroy(EasyBuffer_t *buf);
+
+/*
+ * 数据长度
+ */
+static inline unsigned int BufferLength(const EasyBuffer_t *buf)
+{
+	return buf->tail - buf->head;
+}
+
+/*
+ * 保证至少还能写入len字节，不够时扩容
+ * return：0 on success，-1 on fail
+ */
+int BufferReserve(EasyBuffer_t *buf, unsigned int len);
+
+/*
+ * 追加数据，空间不够时扩容
+ * return：0 on success，-1 on fail
+ */
+int BufferAppend(EasyBuffer_t *buf, const void *data, unsigned int len);
+
+/*
+ * 取出数据
+ * return：取出的字节数
+ */
+unsigned int BufferRead(EasyBuffer_t *buf, void *data, unsigned int len);
+
+/*
+ * 第一段连续数据，不取出
+ * len：保存该段长度
+ * return：数据地址，没有数据时返回NULL
+ */
+const void *BufferPeek(const EasyBuffer_t *buf, unsigned int *len);
+
+/*
+ * 丢弃前len字节
+ */
+void BufferConsume(EasyBuffer_t *buf, unsigned int len);
+
+/*
+ * 数据对应的iovec，用于writev
+ * iov：至少2个元素
+ * return：iovec个数(0~2)
+ */
+int BufferDataIov(const EasyBuffer_t *buf, struct iovec *iov);
+
+/*
+ * 空闲空间对应的iovec，用于readv，读入后调用BufferCommit()
+ * iov：至少2个元素
+ * return：iovec个数(0~2)
+ */
+int BufferSpaceIov(const EasyBuffer_t *buf, struct iovec *iov);
+
+/*
+ * 确认直接写入空闲空间的len字节
+ */
+void BufferCommit(EasyBuffer_t *buf, unsigned int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,447 @@
+/*
+ * 带缓冲的连接实现
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "easy_buffer.h"
+#include "easy_conn.h"
+
+#define CONN_INPUT_SIZE 4096 /* 输入缓冲区初始容量 */
+#define CONN_READ_MIN 1024 /* 每次读之前输入缓冲区至少保留的空间 */
+#define CONN_EXTRA_SIZE 65536 /* 读时附加的栈上缓冲区，缓冲区不够时暂存，避免预先扩容 */
+
+/*
+ * ConnHandle具体结构
+ */
+typedef struct EasyConn_t
+{
+	EventLoopHandle loop;
+	int fd;
+	ConnHandler handler;
+	void *ctx;
+	EasyBuffer_t input; /* 输入缓冲区 */
+	EasyBuffer_t output; /* 输出缓冲区 */
+	int isSocket; /* socket用sendmsg(MSG_NOSIGNAL)，避免SIGPIPE */
+	int writeArmed; /* 正在监听EVENT_WRITE */
+	int flushQueued; /* 已添加延后写出 */
+	int closed; /* 已从事件循环删除 */
+	int error; /* 最近一次错误码 */
+	int pending; /* 回调中产生、等回调返回后通知的事件 */
+	int busy; /* 正在回调 */
+	int destroyed; /* 回调中被销毁，回调返回后释放 */
+}EasyConn_t;
+
+/*
+ * 从事件循环删除，之后不再收到事件
+ */
+static void ConnDetach(EasyConn_t *conn)
+{
+	if (conn->closed)
+		return;
+
+	EventLoopRemove(conn->loop, conn->fd);
+	conn->closed = 1;
+	conn->writeArmed = 0;
+}
+
+/*
+ * 通知用户，回调中产生的事件等回调返回后再通知，不重入
+ */
+static void ConnNotify(EasyConn_t *conn, int events)
+{
+	int ev = 0;
+
+	if (events & (CONN_EVENT_CLOSED | CONN_EVENT_ERROR))
+		ConnDetach(conn);
+
+	conn->pending |= events;
+	if (conn->busy)
+		return;
+
+	conn->busy = 1;
+	while (conn->pending && !conn->destroyed)
+	{
+		ev = conn->pending;
+		conn->pending = 0;
+		conn->handler(conn, ev, conn->ctx);
+	}
+	conn->busy = 0;
+
+	if (conn->destroyed)
+		ConnDestroy(conn);
+}
+
+/*
+ * 写出输出缓冲区，按剩余数据监听或取消EVENT_WRITE
+ * 一次没写完说明内核缓冲区已满，不再重试，等EVENT_WRITE
+ * return：需要通知的事件(CONN_EVENT_DRAIN/CONN_EVENT_ERROR)
+ */
+static int ConnSend(EasyConn_t *conn)
+{
+	struct iovec iov[2];
+	struct msghdr msg;
+	ssize_t n = 0;
+	size_t want = 0;
+	int cnt = 0;
+
+	if (conn->closed)
+		return 0;
+
+	while (BufferLength(&conn->output) > 0)
+	{
+		cnt = BufferDataIov(&conn->output, iov);
+		want = iov[0].iov_len + (cnt > 1 ? iov[1].iov_len : 0);
+
+		if (conn->isSocket)
+		{
+			memset(&msg, 0, sizeof(msg));
+			msg.msg_iov = iov;
+			msg.msg_iovlen = cnt;
+			n = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+		}
+		else
+			n = writev(conn->fd, iov, cnt);
+
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+
+			conn->error = errno;
+			return CONN_EVENT_ERROR;
+		}
+
+		BufferConsume(&conn->output, (unsigned int)n);
+		if ((size_t)n < want)
+			break;
+	}
+
+	if (BufferLength(&conn->output) > 0)
+	{
+		if (!conn->writeArmed)
+		{
+			errno = 0; /* 上面的写入可能留下EAGAIN，失败时只取本次调用的错误码 */
+			if (EventLoopModify(conn->loop, conn->fd, EVENT_READ | EVENT_WRITE) < 0)
+			{
+				conn->error = errno ? errno : ENOMEM;
+				return CONN_EVENT_ERROR;
+			}
+			conn->writeArmed = 1;
+		}
+		return 0;
+	}
+
+	if (conn->writeArmed) /* 积压的数据写完，取消监听，避免一直报告可写 */
+	{
+		EventLoopModify(conn->loop, conn->fd, EVENT_READ);
+		conn->writeArmed = 0;
+		return CONN_EVENT_DRAIN;
+	}
+
+	return 0;
+}
+
+/*
+ * 读入输入缓冲区，缓冲区的空闲空间和栈上缓冲区一起readv
+ * errorReported：事件循环报告了EVENT_ERROR
+ * return：需要通知的事件
+ */
+static int ConnReceive(EasyConn_t *conn, int errorReported)
+{
+	char extra[CONN_EXTRA_SIZE];
+	struct iovec iov[3];
+	socklen_t len = sizeof(int);
+	ssize_t n = 0;
+	size_t space = 0;
+	int cnt = 0, err = 0;
+
+	if (BufferReserve(&conn->input, CONN_READ_MIN) < 0)
+	{
+		conn->error = ENOMEM;
+		return CONN_EVENT_ERROR;
+	}
+
+	cnt = BufferSpaceIov(&conn->input, iov);
+	space = iov[0].iov_len + (cnt > 1 ? iov[1].iov_len : 0);
+	iov[cnt].iov_base = extra;
+	iov[cnt].iov_len = sizeof(extra);
+
+	do
+	{
+		n = readv(conn->fd, iov, cnt + 1);
+	} while (n < 0 && errno == EINTR);
+
+	if (n > 0)
+	{
+		if ((size_t)n <= space)
+			BufferCommit(&conn->input, (unsigned int)n);
+		else
+		{
+			BufferCommit(&conn->input, (unsigned int)space);
+			if (BufferAppend(&conn->input, extra, (unsigned int)(n - space)) < 0)
+			{
+				conn->error = ENOMEM;
+				return CONN_EVENT_READ | CONN_EVENT_ERROR;
+			}
+		}
+		return CONN_EVENT_READ;
+	}
+
+	if (n == 0)
+		return CONN_EVENT_CLOSED;
+
+	if (errno != EAGAIN && errno != EWOULDBLOCK)
+	{
+		conn->error = errno;
+		return CONN_EVENT_ERROR;
+	}
+
+	/* 报告了错误但读不到，从socket取错误码 */
+	if (errorReported && conn->isSocket
+		&& getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err != 0)
+	{
+		conn->error = err;
+		return CONN_EVENT_ERROR;
+	}
+
+	return 0;
+}
+
+/*
+ * 事件循环回调
+ */
+static void ConnOnEvent(EventLoopHandle loop, int fd, int events, void *ctx)
+{
+	EasyConn_t *conn = (EasyConn_t *)ctx;
+	int notify = 0;
+
+	(void)loop;
+	(void)fd;
+
+	if (events & EVENT_WRITE)
+		notify |= ConnSend(conn);
+
+	if ((events & (EVENT_READ | EVENT_ERROR)) && !(notify & CONN_EVENT_ERROR))
+		notify |= ConnReceive(conn, events & EVENT_ERROR);
+
+	if (notify)
+		ConnNotify(conn, notify);
+}
+
+/*
+ * 延后写出：本批次事件分发完后执行，多次写入合并成一次系统调用
+ */
+static void ConnFlushTask(void *arg)
+{
+	EasyConn_t *conn = (EasyConn_t *)arg;
+	int notify = 0;
+
+	conn->flushQueued = 0;
+	notify = ConnSend(conn);
+	if (notify)
+		ConnNotify(conn, notify);
+}
+
+/*
+ * 创建连接并注册到事件循环，fd设置为非阻塞
+ * return：new handle on success，NULL on fail
+ */
+ConnHandle ConnCreate(EventLoopHandle loop, int fd, ConnHandler handler, void *ctx)
+{
+	struct stat st;
+	if (!loop || fd < 0 || !handler)
+		return NULL;
+
+	int flags = fcntl(fd, F_GETFL);
+	if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+		return NULL;
+
+	EasyConn_t *conn = (EasyConn_t *)calloc(1, sizeof(EasyConn_t));
+	if (!conn)
+		return NULL;
+
+	conn->loop = loop;
+	conn->fd = fd;
+	conn->handler = handler;
+	conn->ctx = ctx;
+	conn->isSocket = (fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode));
+	BufferInit(&conn->output, 0);
+
+	if (BufferInit(&conn->input, CONN_INPUT_SIZE) < 0
+		|| EventLoopAdd(loop, fd, EVENT_READ, ConnOnEvent, conn) < 0)
+	{
+		BufferDestroy(&conn->input);
+		free(conn);
+		return NULL;
+	}
+
+	return conn;
+}
+
+/*
+ * 从事件循环删除并销毁连接，不关闭fd
+ * 回调中调用时只做标记，回调返回后释放
+ */
+void ConnDestroy(ConnHandle handle)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn)
+		return;
+
+	ConnDetach(conn);
+	if (conn->flushQueued)
+		EventLoopCancelDefer(conn->loop, ConnFlushTask, conn);
+	conn->flushQueued = 0;
+
+	if (conn->busy)
+	{
+		conn->destroyed = 1;
+		return;
+	}
+
+	BufferDestroy(&conn->input);
+	BufferDestroy(&conn->output);
+	free(conn);
+}
+
+/*
+ * 获取fd
+ * return：fd，失败返回-1
+ */
+int ConnGetFd(ConnHandle handle)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn)
+		return -1;
+
+	return conn->fd;
+}
+
+/*
+ * 获取最近一次读写错误的错误码
+ * return：errno，没有错误返回0
+ */
+int ConnGetError(ConnHandle handle)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn)
+		return 0;
+
+	return conn->error;
+}
+
+/*
+ * 输入缓冲区中的数据长度
+ */
+unsigned int ConnInputLength(ConnHandle handle)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn)
+		return 0;
+
+	return BufferLength(&conn->input);
+}
+
+/*
+ * 输入缓冲区中第一段连续的数据，不取出
+ * len：保存该段长度
+ * return：数据地址，没有数据返回NULL
+ */
+const void *ConnPeek(ConnHandle handle, unsigned int *len)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn || !len)
+		return NULL;
+
+	return BufferPeek(&conn->input, len);
+}
+
+/*
+ * 丢弃输入缓冲区前len字节
+ */
+void ConnConsume(ConnHandle handle, unsigned int len)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn)
+		return;
+
+	BufferConsume(&conn->input, len);
+}
+
+/*
+ * 从输入缓冲区取出数据
+ * return：取出的字节数，失败返回-1
+ */
+int ConnRead(ConnHandle handle, void *data, unsigned int len)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn || (!data && len > 0))
+		return -1;
+
+	return (int)BufferRead(&conn->input, data, len);
+}
+
+/*
+ * 写入输出缓冲区，本批次事件分发完后统一写出
+ * 已经在等EVENT_WRITE时只追加，可写时一起写出
+ * return：0 on success，-1 on fail
+ */
+int ConnWrite(ConnHandle handle, const void *data, unsigned int len)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn || conn->closed || (!data && len > 0))
+		return -1;
+
+	if (BufferAppend(&conn->output, data, len) < 0)
+		return -1;
+
+	if (!conn->writeArmed && !conn->flushQueued && BufferLength(&conn->output) > 0)
+	{
+		if (EventLoopDefer(conn->loop, ConnFlushTask, conn) < 0)
+			return ConnFlush(conn) < 0 ? -1 : 0;
+		conn->flushQueued = 1;
+	}
+
+	return 0;
+}
+
+/*
+ * 输出缓冲区中尚未写出的数据长度
+ */
+unsigned int ConnOutputLength(ConnHandle handle)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn)
+		return 0;
+
+	return BufferLength(&conn->output);
+}
+
+/*
+ * 立即写出输出缓冲区，写不完的部分等EVENT_WRITE
+ * return：剩余未写出的字节数，失败返回-1
+ */
+int ConnFlush(ConnHandle handle)
+{
+	EasyConn_t *conn = (EasyConn_t *)handle;
+	if (!conn || conn->closed)
+		return -1;
+
+	int notify = ConnSend(conn);
+	int left = (notify & CONN_EVENT_ERROR) ? -1 : (int)BufferLength(&conn->output);
+
+	if (notify) /* 回调中可能销毁连接，之后不能再访问 */
+		ConnNotify(conn, notify);
+	return left;
+}
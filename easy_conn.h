@@ -0,0 +1,114 @@
+/*
+ * 带缓冲的连接声明
+ * 在事件循环上为fd维护输入/输出缓冲区：就绪时自动读入，写入先进缓冲区，
+ * 同一批回调中的多次写入在分发完后合并成一次writev，写不完时才监听EVENT_WRITE
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_CONN_H__
+#define __FREE_EASY_CONN_H__
+#include "easy_loop.h"
+
+typedef void *ConnHandle;
+
+/*
+ * 连接事件
+ */
+typedef enum ConnEvent_e
+{
+	CONN_EVENT_READ = 1, /* 输入缓冲区有新数据 */
+	CONN_EVENT_DRAIN = 2, /* 之前写不完积压的数据已全部写出 */
+	CONN_EVENT_CLOSED = 4, /* 对端关闭，输入缓冲区中可能还有未取的数据 */
+	CONN_EVENT_ERROR = 8 /* 读写出错，ConnGetError()获取错误码 */
+}ConnEvent_e;
+
+/*
+ * 连接回调
+ * 收到CONN_EVENT_CLOSED/CONN_EVENT_ERROR时连接已从事件循环删除，之后的写入失败，由用户ConnDestroy()
+ * conn：连接句柄
+ * events：参考ConnEvent_e，可能同时有多个
+ * ctx：创建时的上下文
+ */
+typedef void (*ConnHandler)(ConnHandle conn, int events, void *ctx);
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 创建连接并注册到事件循环，fd设置为非阻塞
+ * 只能在运行事件循环的线程中调用，以下函数相同
+ * loop：事件循环句柄
+ * fd：已连接的socket或pipe
+ * handler：连接回调
+ * ctx：回调的上下文
+ * return：new handle on success，NULL on fail
+ */
+ConnHandle ConnCreate(EventLoopHandle loop, int fd, ConnHandler handler, void *ctx);
+
+/*
+ * 从事件循环删除并销毁连接，不关闭fd，未写出的数据丢弃
+ * 可以在回调中调用，回调返回后释放
+ */
+void ConnDestroy(ConnHandle handle);
+
+/*
+ * 获取fd
+ * return：fd，失败返回-1
+ */
+int ConnGetFd(ConnHandle handle);
+
+/*
+ * 获取最近一次读写错误的错误码
+ * return：errno，没有错误返回0
+ */
+int ConnGetError(ConnHandle handle);
+
+/*
+ * 输入缓冲区中的数据长度
+ */
+unsigned int ConnInputLength(ConnHandle handle);
+
+/*
+ * 输入缓冲区中第一段连续的数据，不取出，处理完后用ConnConsume()丢弃
+ * len：保存该段长度，数据绕回时小于ConnInputLength()
+ * return：数据地址，没有数据返回NULL
+ */
+const void *ConnPeek(ConnHandle handle, unsigned int *len);
+
+/*
+ * 丢弃输入缓冲区前len字节
+ */
+void ConnConsume(ConnHandle handle, unsigned int len);
+
+/*
+ * 从输入缓冲区取出数据
+ * return：取出的字节数，失败返回-1
+ */
+int ConnRead(ConnHandle handle, void *data, unsigned int len);
+
+/*
+ * 写入输出缓冲区，本批次事件分发完后统一写出
+ * return：0 on success，-1 on fail(连接已关闭或内存不足)
+ */
+int ConnWrite(ConnHandle handle, const void *data, unsigned int len);
+
+/*
+ * 输出缓冲区中尚未写出的数据长度
+ */
+unsigned int ConnOutputLength(ConnHandle handle);
+
+/*
+ * 立即写出输出缓冲区，写不完的部分等EVENT_WRITE
+ * return：剩余未写出的字节数，失败返回-1
+ */
+int ConnFlush(ConnHandle handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -19,7 +19,11 @@ typedef enum EventType_e
 {
 	EVENT_READ = 1,
 	EVENT_WRITE = 2,
-	EVENT_ERROR = 4
+	EVENT_ERROR = 4,
+	EVENT_EDGE = 8, /* 边沿触发：epoll使用EPOLLET，poll/select报告后禁用已报告的事件，直到重新激活 */
+	EVENT_ONESHOT = 16, /* 单次触发：报告一次后禁用该fd的全部事件，直到重新激活 */
+	EVENT_TIMER = 32, /* 定时器到期，只出现在返回的事件中，此时fd为-1 */
+	EVENT_EXCLUSIVE = 64 /* 独占唤醒(EPOLLEXCLUSIVE)：多个epoll监听同一fd时每次就绪只唤醒部分等待者，不能与EVENT_ONESHOT同用；poll/select/io_uring忽略 */
 }EventType_e;
 
 /*
@@ -30,8 +34,61 @@ typedef struct EasyEvent_t
 	int fd; /* 监听fd */
 	int event; /* 监听事件，参考EventType_e */
 	int retEvent; /* 返回事件，参考EventType_e */
+	void *userData; /* 用户数据，注册时保存，返回事件时原样带回 */
 }EasyEvent_t;
 
+/*
+ * Poller创建标志
+ */
+typedef enum PollerFlag_e
+{
+	POLLER_FLAG_NOLOCK = 1, /* 不加锁，Poller只能由一个线程使用 */
+	POLLER_FLAG_CHANGELIST = 2, /* 延迟提交：添加/更新/删除只记录，等待事件前合并后一次提交(仅epoll有效) */
+	POLLER_FLAG_STATS_TIME = 4 /* 统计阻塞时间和持锁时间，每次等待/加锁多取两次时钟 */
+}PollerFlag_e;
+
+/*
+ * 投递到Poller线程中执行的任务
+ */
+typedef void (*EasyTaskFunc)(void *arg);
+
+/*
+ * Poller创建参数
+ */
+typedef struct PollerOptions_t
+{
+	int size; /* 预计监听的文件fd数量，超出时自动扩容 */
+	int flags; /* 创建标志，参考PollerFlag_e */
+}PollerOptions_t;
+
+/*
+ * Poller性能计数，创建后单调累加
+ */
+typedef struct PollerStats_t
+{
+	unsigned long long waits; /* 等待次数 */
+	unsigned long long emptyWaits; /* 没有返回事件的等待次数(超时或只被唤醒) */
+	unsigned long long events; /* 返回的事件总数 */
+	unsigned long long maxBatch; /* 单次等待返回的最多事件数 */
+	unsigned long long ctlCalls; /* 修改内核注册的系统调用次数(epoll_ctl)，poll/select/io_uring为0 */
+	unsigned long long addFailures; /* 添加失败次数(内存不足或内核拒绝) */
+	unsigned long long blockedNs; /* 在等待系统调用中的时间(ns)，需要POLLER_FLAG_STATS_TIME */
+	unsigned long long lockHeldNs; /* 持锁时间(ns)，需要POLLER_FLAG_STATS_TIME且未设置POLLER_FLAG_NOLOCK */
+	unsigned long long spinHits; /* 忙轮询期间等到事件的次数 */
+	unsigned long long spinBlocks; /* 忙轮询没有等到事件、转为阻塞等待的次数 */
+}PollerStats_t;
+
+/*
+ * 忙轮询参数，参考PollerSetBusyPoll()
+ */
+typedef struct PollerBusyPoll_t
+{
+	int spinUs; /* 阻塞等待前以0超时反复等待的最长时间(us)，<=0表示不自旋 */
+	int adaptive; /* 非0时按最近事件的到达间隔缩短自旋时间，间隔长于spinUs或连续落空时直接阻塞 */
+	int kernelUs; /* epoll：通过EPIOCSPARAMS让内核在epoll_wait中忙轮询网卡队列的时间(us)，<=0表示不设置 */
+	int kernelBudget; /* 内核每次忙轮询最多处理的包数，<=0使用默认值 */
+}PollerBusyPoll_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,90 @@
+/*
+ * 对数分桶直方图实现
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#include <string.h>
+#include "easy_histogram.h"
+
+/*
+ * 清空直方图
+ */
+void HistogramReset(EasyHistogram_t *hist)
+{
+	memset(hist, 0, sizeof(EasyHistogram_t));
+}
+
+/*
+ * 获取第index个桶的上界(包含)
+ */
+unsigned long long HistogramBucketMax(int index)
+{
+	if (index < HISTOGRAM_SUB_BUCKETS)
+		return (unsigned long long)index;
+
+	int shift = (index >> HISTOGRAM_SUB_BITS) - 1;
+	unsigned long long low = (unsigned long long)(HISTOGRAM_SUB_BUCKETS + (index & (HISTOGRAM_SUB_BUCKETS - 1))) << shift;
+	return low + ((1ULL << shift) - 1);
+}
+
+/*
+ * 计算分位数
+ * percentile：0~100
+ * return：分位数所在桶的上界，不超过最大值；没有记录时返回0
+ */
+unsigned long long HistogramPercentile(const EasyHistogram_t *hist, double percentile)
+{
+	if (!hist || hist->count == 0)
+		return 0;
+
+	if (percentile < 0)
+		percentile = 0;
+	else if (percentile > 100)
+		percentile = 100;
+
+	/* 第rank个值(从1开始)所在的桶 */
+	unsigned long long rank = (unsigned long long)(percentile / 100 * hist->count + 0.5);
+	unsigned long long seen = 0, value = 0;
+	int i = 0;
+
+	if (rank < 1)
+		rank = 1;
+
+	for (; i < HISTOGRAM_BUCKETS; i++)
+	{
+		seen += hist->buckets[i];
+		if (seen >= rank)
+			break;
+	}
+
+	if (i >= HISTOGRAM_BUCKETS)
+		return hist->max;
+
+	value = HistogramBucketMax(i);
+	if (value > hist->max)
+		value = hist->max;
+	if (value < hist->min)
+		value = hist->min;
+	return value;
+}
+
+/*
+ * 把src合并到dst
+ */
+void HistogramMerge(EasyHistogram_t *dst, const EasyHistogram_t *src)
+{
+	int i = 0;
+	if (src->count == 0)
+		return;
+
+	for (; i < HISTOGRAM_BUCKETS; i++)
+		dst->buckets[i] += src->buckets[i];
+
+	if (dst->count == 0 || src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+	dst->count += src->count;
+	dst->sum += src->sum;
+}
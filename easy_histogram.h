@@ -0,0 +1,86 @@
+/*
+ * 对数分桶直方图声明
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_HISTOGRAM_H__
+#define __FREE_EASY_HISTOGRAM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define HISTOGRAM_SUB_BITS 3
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS) /* 每个2的幂区间再细分的桶数，相对误差不超过1/8 */
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS) /* 覆盖全部64位取值 */
+
+/*
+ * 直方图：小于HISTOGRAM_SUB_BUCKETS的值各占一个桶，更大的值按最高位所在的2的幂区间分组，
+ * 每组按次高的HISTOGRAM_SUB_BITS位再分HISTOGRAM_SUB_BUCKETS个桶(与HDR直方图相同的思路)
+ * 记录只有一次数组加法，不加锁，由调用者保证互斥
+ */
+typedef struct EasyHistogram_t
+{
+	unsigned long long count; /* 记录个数 */
+	unsigned long long sum; /* 总和 */
+	unsigned long long min; /* 最小值，没有记录时为0 */
+	unsigned long long max; /* 最大值 */
+	unsigned long long buckets[HISTOGRAM_BUCKETS];
+}EasyHistogram_t;
+
+/*
+ * 计算值所在的桶
+ */
+static inline int HistogramIndex(unsigned long long value)
+{
+	if (value < HISTOGRAM_SUB_BUCKETS)
+		return (int)value;
+
+	int shift = 63 - __builtin_clzll(value) - HISTOGRAM_SUB_BITS; /* 最高位以下保留HISTOGRAM_SUB_BITS位 */
+	return ((shift + 1) << HISTOGRAM_SUB_BITS) + (int)((value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+/*
+ * 记录一个值
+ */
+static inline void HistogramRecord(EasyHistogram_t *hist, unsigned long long value)
+{
+	hist->buckets[HistogramIndex(value)]++;
+	if (hist->count == 0 || value < hist->min)
+		hist->min = value;
+	if (value > hist->max)
+		hist->max = value;
+	hist->count++;
+	hist->sum += value;
+}
+
+/*
+ * 清空直方图
+ */
+void HistogramReset(EasyHistogram_t *hist);
+
+/*
+ * 获取第index个桶的上界(包含)
+ */
+unsigned long long HistogramBucketMax(int index);
+
+/*
+ * 计算分位数
+ * percentile：0~100
+ * return：分位数所在桶的上界，不超过最大值；没有记录时返回0
+ */
+unsigned long long HistogramPercentile(const EasyHistogram_t *hist, double percentile);
+
+/*
+ * 把src合并到dst
+ */
+void HistogramMerge(EasyHistogram_t *dst, const EasyHistogram_t *src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
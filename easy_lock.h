@@ -0,0 +1,95 @@
+/*
+ * 可选互斥锁
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_LOCK_H__
+#define __FREE_EASY_LOCK_H__
+#include <pthread.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 可选互斥锁
+ * 未启用时加锁/解锁只剩一次判断，用于单线程独占的Poller
+ */
+typedef struct EasyLock_t
+{
+	int enabled; /* 是否启用 */
+	int timing; /* 是否统计持锁时间 */
+	long long lockedAt; /* 加锁时刻(ns)，只由持锁线程读写 */
+	unsigned long long heldNs; /* 累计持锁时间(ns) */
+	pthread_mutex_t mutex;
+}EasyLock_t;
+
+static inline long long EasyLockNow(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline void EasyLockInit(EasyLock_t *lock, int enabled)
+{
+	lock->enabled = enabled;
+	lock->timing = 0;
+	lock->lockedAt = 0;
+	lock->heldNs = 0;
+	if (enabled)
+		pthread_mutex_init(&lock->mutex, NULL);
+}
+
+/*
+ * 开始统计持锁时间，未启用的锁不统计
+ */
+static inline void EasyLockTiming(EasyLock_t *lock, int timing)
+{
+	lock->timing = lock->enabled && timing;
+}
+
+/*
+ * 累计持锁时间，其他线程可随时读取
+ */
+static inline unsigned long long EasyLockHeldNs(const EasyLock_t *lock)
+{
+	return __atomic_load_n(&lock->heldNs, __ATOMIC_RELAXED);
+}
+
+static inline void EasyLockDestroy(EasyLock_t *lock)
+{
+	if (lock->enabled)
+		pthread_mutex_destroy(&lock->mutex);
+	lock->enabled = 0;
+}
+
+static inline void EasyLock(EasyLock_t *lock)
+{
+	if (lock->enabled)
+	{
+		pthread_mutex_lock(&lock->mutex);
+		if (lock->timing)
+			lock->lockedAt = EasyLockNow();
+	}
+}
+
+static inline void EasyUnlock(EasyLock_t *lock)
+{
+	if (lock->enabled)
+	{
+		if (lock->timing)
+			__atomic_store_n(&lock->heldNs, lock->heldNs + (EasyLockNow() - lock->lockedAt), __ATOMIC_RELAXED);
+		pthread_mutex_unlock(&lock->mutex);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,763 @@
+/*
+ * 事件循环实现
+ * 回调按fd存放在数组中，注册时把序号和fd一起作为userData，分发时不用查找，序号不符的旧事件直接跳过
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include "easy_stats.h"
+#include "easy_loop.h"
+
+#define LOOP_DEFAULT_EVENTS 64 /* 默认每次等待返回的事件个数 */
+#define LOOP_MAX_EVENTS 4096 /* 每次等待返回的事件个数上限 */
+
+/*
+ * userData：高位为序号，低位为fd或定时器下标，按指针宽度划分
+ * 32位平台上fd和定时器下标不超过2^20，序号只保留12位，比较时只比较保留的位
+ */
+#if UINTPTR_MAX > 0xffffffffu
+#define LOOP_IDX_BITS 32
+#define LOOP_IDX_LIMIT INT_MAX
+#else
+#define LOOP_IDX_BITS 20
+#define LOOP_IDX_LIMIT (1 << LOOP_IDX_BITS)
+#endif
+#define LOOP_IDX_MASK (((uintptr_t)1 << LOOP_IDX_BITS) - 1)
+#define LOOP_PACK(gen, idx) ((void *)(((uintptr_t)(gen) << LOOP_IDX_BITS) | ((uintptr_t)(idx) & LOOP_IDX_MASK)))
+#define LOOP_IDX(data) ((int)((uintptr_t)(data) & LOOP_IDX_MASK))
+#define LOOP_GEN_MATCH(gen, data) (((uintptr_t)(gen) << LOOP_IDX_BITS) == ((uintptr_t)(data) & ~LOOP_IDX_MASK))
+
+/*
+ * 每个fd的回调
+ */
+typedef struct LoopFd_t
+{
+	EventLoopHandler handler; /* NULL表示未注册 */
+	void *ctx;
+	unsigned int gen; /* 每次注册/删除加1，用于丢弃旧事件 */
+	int event; /* 监听事件 */
+}LoopFd_t;
+
+/*
+ * 定时器，按下标链接，数组扩容后下标不变
+ */
+typedef struct LoopTimer_t
+{
+	EventLoopHandler handler; /* NULL表示空闲 */
+	void *ctx;
+	long long timerId; /* Poller定时器id */
+	unsigned int gen; /* 每次分配/释放加1，与下标组成定时器id */
+	int next; /* 空闲链表 */
+}LoopTimer_t;
+
+/*
+ * 延后执行的函数
+ */
+typedef struct LoopDefer_t
+{
+	EasyTaskFunc func; /* NULL表示已取消 */
+	void *arg;
+}LoopDefer_t;
+
+/*
+ * EventLoopHandle具体结构
+ */
+typedef struct EasyLoop_t
+{
+	PollerHandle poller;
+	EasyEvent_t *events; /* 等待用的事件数组，重复使用 */
+	int maxEvents; /* events数组大小 */
+	LoopFd_t *fds; /* 按fd索引的回调 */
+	int fdCount; /* fds数组大小 */
+	LoopTimer_t *timers; /* 定时器数组 */
+	int timerCount; /* timers数组大小 */
+	int timerFree; /* 空闲定时器链表 */
+	LoopDefer_t *defers; /* 延后执行的函数 */
+	int deferCount; /* 个数 */
+	int deferSize; /* defers数组大小 */
+	int stop; /* EventLoopStop()设置 */
+	EventLoopProfile_t *profile; /* 耗时统计，首次开启时分配，关闭后保留 */
+	int profiling; /* 是否正在统计 */
+}EasyLoop_t;
+
+/*
+ * 获取fd的回调，不存在时扩容
+ * return：回调，失败返回NULL
+ */
+static LoopFd_t *LoopFdAlloc(EasyLoop_t *ep, int fd)
+{
+	if (fd >= ep->fdCount)
+	{
+		int count = ep->fdCount ? ep->fdCount : 64;
+		while (count <= fd)
+			count <<= 1;
+
+		LoopFd_t *fds = (LoopFd_t *)realloc(ep->fds, count * sizeof(LoopFd_t));
+		if (!fds)
+			return NULL;
+
+		int i = ep->fdCount;
+		for (; i < count; i++)
+		{
+			fds[i].handler = NULL;
+			fds[i].ctx = NULL;
+			fds[i].gen = 0;
+			fds[i].event = 0;
+		}
+
+		ep->fds = fds;
+		ep->fdCount = count;
+	}
+
+	return &ep->fds[fd];
+}
+
+/*
+ * 获取已注册fd的回调
+ * return：回调，未注册返回NULL
+ */
+static LoopFd_t *LoopFdGet(EasyLoop_t *ep, int fd)
+{
+	if (fd < 0 || fd >= ep->fdCount || !ep->fds[fd].handler)
+		return NULL;
+
+	return &ep->fds[fd];
+}
+
+/*
+ * 分配定时器
+ * return：下标，失败返回-1
+ */
+static int LoopTimerAlloc(EasyLoop_t *ep)
+{
+	if (ep->timerFree < 0) /* 扩容 */
+	{
+		int count = ep->timerCount ? ep->timerCount * 2 : 64;
+		if (count > LOOP_IDX_LIMIT)
+			return -1;
+
+		LoopTimer_t *timers = (LoopTimer_t *)realloc(ep->timers, count * sizeof(LoopTimer_t));
+		if (!timers)
+			return -1;
+
+		int i = ep->timerCount;
+		for (; i < count; i++)
+		{
+			timers[i].handler = NULL;
+			timers[i].gen = 0;
+			timers[i].next = (i + 1 < count) ? (i + 1) : -1;
+		}
+
+		ep->timerFree = ep->timerCount;
+		ep->timers = timers;
+		ep->timerCount = count;
+	}
+
+	int idx = ep->timerFree;
+	ep->timerFree = ep->timers[idx].next;
+	ep->timers[idx].gen++;
+	return idx;
+}
+
+/*
+ * 释放定时器
+ */
+static void LoopTimerFree(EasyLoop_t *ep, int idx)
+{
+	ep->timers[idx].handler = NULL;
+	ep->timers[idx].gen++;
+	ep->timers[idx].next = ep->timerFree;
+	ep->timerFree = idx;
+}
+
+/*
+ * 创建事件循环，底层Poller不加锁(POLLER_FLAG_NOLOCK)
+ * type：Poller类型
+ * size：每次等待最多返回的事件个数，<=0时使用默认值
+ * return：new handle on success，NULL on fail
+ */
+EventLoopHandle EventLoopCreate(PollerType_e type, int size)
+{
+	PollerOptions_t options;
+
+	options.size = size;
+	options.flags = POLLER_FLAG_NOLOCK;
+
+	return EventLoopCreateEx(type, &options);
+}
+
+/*
+ * 按参数创建事件循环
+ * options：传给PollerCreateEx()，size同时作为每次等待最多返回的事件个数；NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+EventLoopHandle EventLoopCreateEx(PollerType_e type, const PollerOptions_t *options)
+{
+	int size = options ? options->size : 0;
+
+	EasyLoop_t *ep = (EasyLoop_t *)calloc(1, sizeof(EasyLoop_t));
+	if (!ep)
+		return NULL;
+
+	if (size <= 0)
+		size = LOOP_DEFAULT_EVENTS;
+	else if (size > LOOP_MAX_EVENTS)
+		size = LOOP_MAX_EVENTS;
+
+	ep->maxEvents = size;
+	ep->timerFree = -1;
+	ep->events = (EasyEvent_t *)malloc(size * sizeof(EasyEvent_t));
+	ep->poller = PollerCreateEx(type, options);
+	if (!ep->events || !ep->poller)
+	{
+		EventLoopDestroy(ep);
+		return NULL;
+	}
+
+	return ep;
+}
+
+/*
+ * 销毁事件循环，不能在回调中调用
+ * handle：EventLoopCreate()返回的句柄
+ */
+void EventLoopDestroy(EventLoopHandle handle)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return;
+
+	if (ep->poller)
+		PollerDestroy(ep->poller);
+	ep->poller = NULL;
+
+	if (ep->events)
+		free(ep->events);
+	ep->events = NULL;
+
+	if (ep->fds)
+		free(ep->fds);
+	ep->fds = NULL;
+
+	if (ep->timers)
+		free(ep->timers);
+	ep->timers = NULL;
+
+	if (ep->profile)
+		free(ep->profile);
+	ep->profile = NULL;
+
+	if (ep->defers)
+		free(ep->defers);
+	ep->defers = NULL;
+
+	free(ep);
+}
+
+/*
+ * 获取底层Poller，可用于PollerPostTask()等
+ * return：Poller句柄，失败返回NULL
+ */
+PollerHandle EventLoopGetPoller(EventLoopHandle handle)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return NULL;
+
+	return ep->poller;
+}
+
+/*
+ * 注册fd
+ * handle：事件循环句柄
+ * fd：文件fd
+ * events：监听事件，参考EventType_e
+ * handler：事件回调
+ * ctx：回调的上下文
+ * return：0 on success，-1 on fail(已注册或Poller添加失败)
+ */
+int EventLoopAdd(EventLoopHandle handle, int fd, int events, EventLoopHandler handler, void *ctx)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep || fd < 0 || fd >= LOOP_IDX_LIMIT || !handler)
+		return -1;
+
+	LoopFd_t *lf = LoopFdAlloc(ep, fd);
+	if (!lf || lf->handler)
+		return -1;
+
+	EasyEvent_t event;
+	event.fd = fd;
+	event.event = events;
+	event.retEvent = 0;
+	event.userData = LOOP_PACK(lf->gen + 1, fd);
+
+	if (PollerAddEvent(ep->poller, &event) != 0)
+		return -1;
+
+	lf->gen++;
+	lf->handler = handler;
+	lf->ctx = ctx;
+	lf->event = events;
+	return 0;
+}
+
+/*
+ * 修改监听事件，回调和上下文不变
+ * return：0 on success，-1 on fail
+ */
+int EventLoopModify(EventLoopHandle handle, int fd, int events)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return -1;
+
+	LoopFd_t *lf = LoopFdGet(ep, fd);
+	if (!lf)
+		return -1;
+
+	EasyEvent_t event;
+	event.fd = fd;
+	event.event = events;
+	event.retEvent = 0;
+	event.userData = LOOP_PACK(lf->gen, fd);
+
+	if (PollerUpdateEvent(ep->poller, &event) != 0)
+		return -1;
+
+	lf->event = events;
+	return 0;
+}
+
+/*
+ * 重新激活EVENT_EDGE/EVENT_ONESHOT事件
+ * return：0 on success，-1 on fail
+ */
+int EventLoopRearm(EventLoopHandle handle, int fd)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep || !LoopFdGet(ep, fd))
+		return -1;
+
+	EasyEvent_t event;
+	event.fd = fd;
+	event.event = 0;
+	event.retEvent = 0;
+	event.userData = NULL;
+
+	return PollerRearmEvent(ep->poller, &event);
+}
+
+/*
+ * 删除fd
+ * 序号加1，本批次中尚未分发的旧事件因序号不符被跳过
+ * return：0 on success，-1 on fail
+ */
+int EventLoopRemove(EventLoopHandle handle, int fd)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return -1;
+
+	LoopFd_t *lf = LoopFdGet(ep, fd);
+	if (!lf)
+		return -1;
+
+	EasyEvent_t event;
+	event.fd = fd;
+	event.event = lf->event;
+	event.retEvent = 0;
+	event.userData = NULL;
+
+	if (PollerRemoveEvent(ep->poller, &event) < 0)
+		return -1;
+
+	lf->gen++;
+	lf->handler = NULL;
+	lf->ctx = NULL;
+	lf->event = 0;
+	return 0;
+}
+
+/*
+ * 添加一次性定时器，到期时以fd=-1、EVENT_TIMER调用handler
+ * handle：事件循环句柄
+ * timeout：超时时间(ms)
+ * handler：到期回调
+ * ctx：回调的上下文
+ * return：定时器id(>0)，失败返回-1
+ */
+long long EventLoopAddTimer(EventLoopHandle handle, int timeout, EventLoopHandler handler, void *ctx)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep || !handler || timeout < 0)
+		return -1;
+
+	int idx = LoopTimerAlloc(ep);
+	if (idx < 0)
+		return -1;
+
+	LoopTimer_t *lt = &ep->timers[idx];
+	lt->timerId = PollerAddTimer(ep->poller, timeout, LOOP_PACK(lt->gen, idx));
+	if (lt->timerId < 0)
+	{
+		LoopTimerFree(ep, idx);
+		return -1;
+	}
+
+	lt->handler = handler;
+	lt->ctx = ctx;
+
+	/* 高位为序号，低位为下标+1 */
+	return ((long long)(lt->gen & 0x7fffffff) << 32) | (unsigned int)(idx + 1);
+}
+
+/*
+ * 删除定时器
+ * timerId：EventLoopAddTimer()返回的id
+ * return：0 on success，-1 on fail(不存在或已分发)
+ */
+int EventLoopCancelTimer(EventLoopHandle handle, long long timerId)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	int idx = (int)(timerId & 0xffffffff) - 1;
+	if (!ep || timerId <= 0 || idx < 0 || idx >= ep->timerCount)
+		return -1;
+
+	LoopTimer_t *lt = &ep->timers[idx];
+	if (!lt->handler || (lt->gen & 0x7fffffff) != (unsigned int)(timerId >> 32))
+		return -1;
+
+	/* 已到期、在本批次中等待分发时Poller删除失败，释放后序号不符不再分发 */
+	PollerCancelTimer(ep->poller, lt->timerId);
+	LoopTimerFree(ep, idx);
+	return 0;
+}
+
+/*
+ * 投递任务到事件循环线程执行，任意线程可调用
+ * return：0 on success，-1 on fail
+ */
+int EventLoopPostTask(EventLoopHandle handle, EasyTaskFunc func, void *arg)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return -1;
+
+	return PollerPostTask(ep->poller, func, arg);
+}
+
+/*
+ * 延后执行
+ * return：0 on success，-1 on fail
+ */
+int EventLoopDefer(EventLoopHandle handle, EasyTaskFunc func, void *arg)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep || !func)
+		return -1;
+
+	if (ep->deferCount >= ep->deferSize)
+	{
+		int size = ep->deferSize ? ep->deferSize * 2 : 64;
+		LoopDefer_t *defers = (LoopDefer_t *)realloc(ep->defers, size * sizeof(LoopDefer_t));
+		if (!defers)
+			return -1;
+
+		ep->defers = defers;
+		ep->deferSize = size;
+	}
+
+	ep->defers[ep->deferCount].func = func;
+	ep->defers[ep->deferCount].arg = arg;
+	ep->deferCount++;
+	return 0;
+}
+
+/*
+ * 取消尚未执行的延后执行
+ * 只清空函数，执行时跳过，正在执行时下标不变
+ * return：取消的个数，失败返回-1
+ */
+int EventLoopCancelDefer(EventLoopHandle handle, EasyTaskFunc func, void *arg)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	int i = 0, count = 0;
+	if (!ep)
+		return -1;
+
+	for (; i < ep->deferCount; i++)
+	{
+		if (ep->defers[i].func == func && ep->defers[i].arg == arg)
+		{
+			ep->defers[i].func = NULL;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * 执行延后的函数，执行中新添加的也一起执行
+ */
+static void LoopRunDefers(EasyLoop_t *ep)
+{
+	int i = 0;
+	EasyTaskFunc func = NULL;
+	void *arg = NULL;
+
+	for (; i < ep->deferCount; i++) /* 执行中可能扩容，每次重新取 */
+	{
+		func = ep->defers[i].func;
+		arg = ep->defers[i].arg;
+		if (func)
+		{
+			ep->defers[i].func = NULL;
+			func(arg);
+		}
+	}
+
+	ep->deferCount = 0;
+}
+
+/*
+ * 分发一个定时器事件
+ */
+static void LoopDispatchTimer(EasyLoop_t *ep, void *userData)
+{
+	int idx = LOOP_IDX(userData);
+	if (idx >= ep->timerCount)
+		return;
+
+	LoopTimer_t *lt = &ep->timers[idx];
+	if (!lt->handler || !LOOP_GEN_MATCH(lt->gen, userData)) /* 已删除 */
+		return;
+
+	/* 先释放，回调中可以重新添加 */
+	EventLoopHandler handler = lt->handler;
+	void *ctx = lt->ctx;
+	LoopTimerFree(ep, idx);
+
+	handler(ep, -1, EVENT_TIMER, ctx);
+}
+
+/*
+ * 一个回调结束，记录耗时并更新本轮最慢的回调
+ * start：回调开始时间(ns)
+ */
+static void LoopProfileHandler(EventLoopProfile_t *prof, long long start, int fd, int events, EventLoopSlow_t *worst)
+{
+	long long cost = StatsNow() - start;
+
+	HistogramRecord(&prof->handler, cost);
+	if (cost > worst->handlerNs)
+	{
+		worst->fd = fd;
+		worst->events = events;
+		worst->handlerNs = cost;
+	}
+}
+
+/*
+ * 一轮分发结束，记录耗时，超过阈值时保存最慢的回调
+ * begin：等待返回的时间(ns)
+ */
+static void LoopProfileIteration(EventLoopProfile_t *prof, long long begin, int batch, EventLoopSlow_t *worst)
+{
+	long long cost = StatsNow() - begin;
+
+	HistogramRecord(&prof->iteration, cost);
+	if (prof->slowNs <= 0 || cost < prof->slowNs)
+		return;
+
+	if (worst->handlerNs < 0) /* 本轮的事件都已失效，没有执行回调 */
+		worst->handlerNs = 0;
+	worst->batch = batch;
+	worst->iterationNs = cost;
+	prof->slow[prof->slowCount % EVENT_LOOP_SLOW_RECORDS] = *worst;
+	prof->slowCount++;
+}
+
+/*
+ * 等待一次并分发事件
+ * 分发时预取后面事件的回调和上下文
+ * timeout：超时时间(ms)
+ * return：分发的事件个数，失败返回-1
+ */
+int EventLoopRunOnce(EventLoopHandle handle, int timeout)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return -1;
+
+	if (ep->deferCount > 0) /* 回调之外添加的，等待前执行 */
+		LoopRunDefers(ep);
+
+	EasyEvent_t *events = ep->events;
+	int nums = PollerWaitEvent(ep->poller, events, ep->maxEvents, timeout);
+
+	/* 开启统计后每个回调前后取时钟，未开启时只有这里的判断 */
+	EventLoopProfile_t *prof = ep->profiling ? ep->profile : NULL;
+	EventLoopSlow_t worst = {-1, 0, 0, 0, -1};
+	long long begin = 0, start = 0;
+
+	if (prof && nums >= 0)
+	{
+		begin = StatsNow();
+		HistogramRecord(&prof->batch, nums);
+	}
+
+	if (nums <= 0)
+	{
+		if (ep->deferCount > 0) /* 等待中执行的任务添加的 */
+			LoopRunDefers(ep);
+		return nums;
+	}
+
+	int i = 0, fd = -1, count = 0;
+	LoopFd_t *lf = NULL;
+
+	if (events[0].fd >= 0 && events[0].fd < ep->fdCount)
+		__builtin_prefetch(&ep->fds[events[0].fd]);
+
+	for (; i < nums; i++)
+	{
+		/* 下下个事件的回调，下个事件的上下文(回调已在上一轮预取) */
+		if (i + 2 < nums && events[i + 2].fd >= 0 && events[i + 2].fd < ep->fdCount)
+			__builtin_prefetch(&ep->fds[events[i + 2].fd]);
+		if (i + 1 < nums && events[i + 1].fd >= 0 && events[i + 1].fd < ep->fdCount)
+			__builtin_prefetch(ep->fds[events[i + 1].fd].ctx);
+
+		fd = events[i].fd;
+		if (fd < 0)
+		{
+			if (events[i].retEvent & EVENT_TIMER)
+			{
+				if (prof)
+					start = StatsNow();
+				LoopDispatchTimer(ep, events[i].userData);
+				if (prof)
+					LoopProfileHandler(prof, start, -1, EVENT_TIMER, &worst);
+				count++;
+			}
+			continue;
+		}
+
+		/* 回调中扩容会移动fds数组，每次重新取 */
+		if (fd >= ep->fdCount)
+			continue;
+
+		lf = &ep->fds[fd];
+		if (!lf->handler || !LOOP_GEN_MATCH(lf->gen, events[i].userData)) /* 本批次中已删除或重新注册 */
+			continue;
+
+		if (prof)
+		{
+			start = StatsNow();
+			lf->handler(ep, fd, events[i].retEvent, lf->ctx);
+			LoopProfileHandler(prof, start, fd, events[i].retEvent, &worst);
+		}
+		else
+			lf->handler(ep, fd, events[i].retEvent, lf->ctx);
+		count++;
+	}
+
+	if (ep->deferCount > 0)
+		LoopRunDefers(ep);
+
+	if (prof)
+		LoopProfileIteration(prof, begin, nums, &worst);
+
+	return count;
+}
+
+/*
+ * 循环等待并分发事件，直到EventLoopStop()
+ * return：0 on success，-1 on fail
+ */
+int EventLoopRun(EventLoopHandle handle)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return -1;
+
+	while (!__atomic_load_n(&ep->stop, __ATOMIC_ACQUIRE))
+	{
+		if (EventLoopRunOnce(ep, -1) < 0 && errno != EINTR)
+			return -1;
+	}
+
+	__atomic_store_n(&ep->stop, 0, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/*
+ * 停止EventLoopRun()，任意线程可调用，当前批次分发完后返回
+ */
+void EventLoopStop(EventLoopHandle handle)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return;
+
+	__atomic_store_n(&ep->stop, 1, __ATOMIC_RELEASE);
+	PollerWakeup(ep->poller);
+}
+
+/*
+ * 开始统计耗时分布，清空之前的统计
+ * slowNs：一轮耗时超过该值(ns)时记录耗时最长的回调的fd，<=0表示不记录
+ * return：0 on success，-1 on fail
+ */
+int EventLoopEnableProfile(EventLoopHandle handle, long long slowNs)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return -1;
+
+	if (!ep->profile)
+	{
+		ep->profile = (EventLoopProfile_t *)malloc(sizeof(EventLoopProfile_t));
+		if (!ep->profile)
+			return -1;
+	}
+
+	/* 在回调中开启时从下次等待返回后开始统计 */
+	memset(ep->profile, 0, sizeof(EventLoopProfile_t));
+	ep->profile->slowNs = slowNs;
+	ep->profiling = 1;
+	return 0;
+}
+
+/*
+ * 停止统计，已统计的数据保留到下次开启
+ */
+void EventLoopDisableProfile(EventLoopHandle handle)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep)
+		return;
+
+	ep->profiling = 0;
+}
+
+/*
+ * 拷贝统计数据
+ * profile：保存统计数据
+ * return：0 on success，-1 on fail(未开启过)
+ */
+int EventLoopGetProfile(EventLoopHandle handle, EventLoopProfile_t *profile)
+{
+	EasyLoop_t *ep = (EasyLoop_t *)handle;
+	if (!ep || !ep->profile || !profile)
+		return -1;
+
+	memcpy(profile, ep->profile, sizeof(EventLoopProfile_t));
+	return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * 事件循环声明
+ * 按fd注册回调函数和上下文，由EventLoopRun()等待并分发事件
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_LOOP_H__
+#define __FREE_EASY_LOOP_H__
+#include "easy_poller.h"
+#include "easy_histogram.h"
+
+typedef void *EventLoopHandle;
+
+#define EVENT_LOOP_SLOW_RECORDS 64 /* 保留的最近慢轮次个数 */
+
+/*
+ * 事件回调
+ * loop：事件循环句柄
+ * fd：触发的fd，定时器为-1
+ * events：返回事件，参考EventType_e，定时器为EVENT_TIMER
+ * ctx：注册时的上下文
+ */
+typedef void (*EventLoopHandler)(EventLoopHandle loop, int fd, int events, void *ctx);
+
+/*
+ * 一次超过阈值的轮次
+ */
+typedef struct EventLoopSlow_t
+{
+	int fd; /* 本轮耗时最长的回调的fd，定时器为-1 */
+	int events; /* 该回调的返回事件 */
+	int batch; /* 本轮分发的事件个数 */
+	long long iterationNs; /* 本轮耗时(ns)，从等待返回到分发结束 */
+	long long handlerNs; /* 该回调的耗时(ns) */
+}EventLoopSlow_t;
+
+/*
+ * 事件循环的耗时分布
+ */
+typedef struct EventLoopProfile_t
+{
+	EasyHistogram_t iteration; /* 每轮从等待返回到分发结束的耗时(ns)，即两次等待之间的时间 */
+	EasyHistogram_t batch; /* 每次等待返回的事件个数，包括0(超时或被唤醒) */
+	EasyHistogram_t handler; /* 每个回调的耗时(ns)，包括定时器回调 */
+	long long slowNs; /* 慢轮次阈值(ns)，<=0表示不记录 */
+	unsigned long long slowCount; /* 超过阈值的轮数 */
+	EventLoopSlow_t slow[EVENT_LOOP_SLOW_RECORDS]; /* 最近的慢轮次，环形存放，第slowCount-1个在slow[(slowCount-1) % EVENT_LOOP_SLOW_RECORDS] */
+}EventLoopProfile_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 创建事件循环，底层Poller不加锁(POLLER_FLAG_NOLOCK)
+ * type：Poller类型
+ * size：每次等待最多返回的事件个数，<=0时使用默认值
+ * return：new handle on success，NULL on fail
+ */
+EventLoopHandle EventLoopCreate(PollerType_e type, int size);
+
+/*
+ * 按参数创建事件循环
+ * options：传给PollerCreateEx()，size同时作为每次等待最多返回的事件个数；NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+EventLoopHandle EventLoopCreateEx(PollerType_e type, const PollerOptions_t *options);
+
+/*
+ * 销毁事件循环，不能在回调中调用
+ * handle：EventLoopCreate()返回的句柄
+ */
+void EventLoopDestroy(EventLoopHandle handle);
+
+/*
+ * 获取底层Poller，可用于PollerPostTask()等
+ * return：Poller句柄，失败返回NULL
+ */
+PollerHandle EventLoopGetPoller(EventLoopHandle handle);
+
+/*
+ * 注册fd
+ * 注册/修改/删除只能在运行事件循环的线程中调用(包括回调中)
+ * handle：事件循环句柄
+ * fd：文件fd
+ * events：监听事件，参考EventType_e
+ * handler：事件回调
+ * ctx：回调的上下文
+ * return：0 on success，-1 on fail(已注册或Poller添加失败；32位平台上fd不能超过2^20)
+ */
+int EventLoopAdd(EventLoopHandle handle, int fd, int events, EventLoopHandler handler, void *ctx);
+
+/*
+ * 修改监听事件，回调和上下文不变
+ * return：0 on success，-1 on fail
+ */
+int EventLoopModify(EventLoopHandle handle, int fd, int events);
+
+/*
+ * 重新激活EVENT_EDGE/EVENT_ONESHOT事件
+ * return：0 on success，-1 on fail
+ */
+int EventLoopRearm(EventLoopHandle handle, int fd);
+
+/*
+ * 删除fd
+ * 在回调中删除时，本批次中该fd尚未分发的事件不再分发；删除后重新注册的同一fd也不会收到旧事件
+ * fd已经关闭时也能删除，之后同一fd号可以重新注册
+ * return：0 on success，-1 on fail
+ */
+int EventLoopRemove(EventLoopHandle handle, int fd);
+
+/*
+ * 添加一次性定时器，到期时以fd=-1、EVENT_TIMER调用handler
+ * handle：事件循环句柄
+ * timeout：超时时间(ms)
+ * handler：到期回调
+ * ctx：回调的上下文
+ * return：定时器id(>0)，失败返回-1
+ */
+long long EventLoopAddTimer(EventLoopHandle handle, int timeout, EventLoopHandler handler, void *ctx);
+
+/*
+ * 删除定时器，本批次中已到期但尚未分发的定时器也不再分发
+ * timerId：EventLoopAddTimer()返回的id
+ * return：0 on success，-1 on fail(不存在或已分发)
+ */
+int EventLoopCancelTimer(EventLoopHandle handle, long long timerId);
+
+/*
+ * 投递任务到事件循环线程执行，任意线程可调用
+ * return：0 on success，-1 on fail
+ */
+int EventLoopPostTask(EventLoopHandle handle, EasyTaskFunc func, void *arg);
+
+/*
+ * 延后执行：本批次事件分发完后、下次等待前在当前线程执行，用于把一批回调中的多次操作合并成一次
+ * 只能在运行事件循环的线程中调用(包括回调和延后执行的函数中，此时在本次一起执行)
+ * 同一func/arg重复添加会执行多次；事件循环销毁时未执行的直接丢弃
+ * return：0 on success，-1 on fail
+ */
+int EventLoopDefer(EventLoopHandle handle, EasyTaskFunc func, void *arg);
+
+/*
+ * 取消尚未执行的延后执行，func/arg与EventLoopDefer()相同的全部取消
+ * return：取消的个数，失败返回-1
+ */
+int EventLoopCancelDefer(EventLoopHandle handle, EasyTaskFunc func, void *arg);
+
+/*
+ * 等待一次并分发事件
+ * timeout：超时时间(ms)
+ * return：分发的事件个数，失败返回-1
+ */
+int EventLoopRunOnce(EventLoopHandle handle, int timeout);
+
+/*
+ * 循环等待并分发事件，直到EventLoopStop()
+ * return：0 on success，-1 on fail
+ */
+int EventLoopRun(EventLoopHandle handle);
+
+/*
+ * 停止EventLoopRun()，任意线程可调用，当前批次分发完后返回
+ */
+void EventLoopStop(EventLoopHandle handle);
+
+/*
+ * 开始统计耗时分布，清空之前的统计
+ * 每个回调前后各取一次时钟；未开启时分发路径上只多一次判断
+ * 投递的任务在等待中执行，不计入
+ * 只能在运行事件循环的线程中调用(包括回调中)
+ * handle：事件循环句柄
+ * slowNs：一轮耗时超过该值(ns)时记录耗时最长的回调的fd，<=0表示不记录
+ * return：0 on success，-1 on fail
+ */
+int EventLoopEnableProfile(EventLoopHandle handle, long long slowNs);
+
+/*
+ * 停止统计，已统计的数据保留到下次开启
+ * 只能在运行事件循环的线程中调用
+ */
+void EventLoopDisableProfile(EventLoopHandle handle);
+
+/*
+ * 拷贝统计数据，其他线程读取时用EventLoopPostTask()在事件循环线程中调用
+ * profile：保存统计数据
+ * return：0 on success，-1 on fail(未开启过)
+ */
+int EventLoopGetProfile(EventLoopHandle handle, EventLoopProfile_t *profile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -1,59 +1,339 @@
 /*
- * 3种POLL封装实现
+ * 4种POLL封装实现
  * Copyright FreeCode. All Rights Reserved.
  * MIT License (https://opensource.org/licenses/MIT)
  * 2025 by liuqingshuige
  */
+#define _GNU_SOURCE
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "easy_lock.h"
+#include "easy_timer.h"
+#include "easy_task.h"
+#include "easy_stats.h"
 #include "epoll_poller.h"
 #include "poll_poller.h"
 #include "select_poller.h"
+#include "uring_poller.h"
 #include "easy_poller.h"
 
+/*
+ * 后端操作表，创建时按类型选定，之后的调用不再逐个比较类型
+ * 各后端句柄都是void *，函数可以直接放入表中
+ */
+typedef struct PollerOps_t
+{
+	void *(*create)(const PollerOptions_t *options);
+	void (*destroy)(void *poller);
+	int (*wait)(void *poller, EasyEvent_t *events, int maxevents, int timeout);
+	int (*add)(void *poller, const EasyEvent_t *event);
+	int (*adds)(void *poller, const EasyEvent_t *events, int count, int *results);
+	int (*update)(void *poller, const EasyEvent_t *event);
+	int (*updates)(void *poller, const EasyEvent_t *events, int count, int *results);
+	int (*remove)(void *poller, const EasyEvent_t *event);
+	int (*removes)(void *poller, const EasyEvent_t *events, int count, int *results);
+	int (*rearm)(void *poller, const EasyEvent_t *event);
+	int (*stats)(void *poller, PollerStats_t *stats);
+	int (*busyPoll)(void *poller, int usecs, int budget); /* 内核忙轮询，不支持时为NULL */
+}PollerOps_t;
+
+static const PollerOps_t EPOLL_OPS = {
+	EpollCreateEx, EpollDestroy, EpollWaitEvent,
+	EpollAddEvent, EpollAddEvents, EpollUpdateEvent, EpollUpdateEvents,
+	EpollRemoveEvent, EpollRemoveEvents, EpollRearmEvent, EpollGetStats,
+	EpollSetBusyPoll
+};
+
+#ifndef EASY_POLLER_PIN_EPOLL
+static const PollerOps_t POLL_OPS = {
+	PollCreateEx, PollDestroy, PollWaitEvent,
+	PollAddEvent, PollAddEvents, PollUpdateEvent, PollUpdateEvents,
+	PollRemoveEvent, PollRemoveEvents, PollRearmEvent, PollGetStats,
+	NULL
+};
+
+static const PollerOps_t SELECT_OPS = {
+	SelectCreateEx, SelectDestroy, SelectWaitEvent,
+	SelectAddEvent, SelectAddEvents, SelectUpdateEvent, SelectUpdateEvents,
+	SelectRemoveEvent, SelectRemoveEvents, SelectRearmEvent, SelectGetStats,
+	NULL
+};
+
+static const PollerOps_t URING_OPS = {
+	UringCreateEx, UringDestroy, UringWaitEvent,
+	UringAddEvent, UringAddEvents, UringUpdateEvent, UringUpdateEvents,
+	UringRemoveEvent, UringRemoveEvents, UringRearmEvent, UringGetStats,
+	NULL
+};
+#endif
+
+/*
+ * 取操作表：定义EASY_POLLER_PIN_EPOLL时固定为epoll，编译器直接调用Epoll函数，没有间接跳转
+ */
+#ifdef EASY_POLLER_PIN_EPOLL
+#define POLLER_OPS(ep) (&EPOLL_OPS)
+#else
+#define POLLER_OPS(ep) ((ep)->ops)
+#endif
+
 /*
  * PollerHandle具体结构
  */
 typedef struct Poller_t
 {
 	PollerType_e type; /* poller类型 */
+	const PollerOps_t *ops; /* 后端操作表 */
 	void *poller; /* poller句柄 */
+	EasyTimerWheel_t timers; /* 定时器 */
+	EasyLock_t lock; /* 保护定时器，POLLER_FLAG_NOLOCK时不启用 */
+	int wakeFd[2]; /* 唤醒fd：[0]读端，[1]写端，eventfd时两者相同 */
+	int wakePending; /* 已写入唤醒、等待线程尚未处理，同一批投递只写一次 */
+	int wakeUser; /* 由PollerWakeup()/PollerPostTask()唤醒，等待需要返回 */
+	int waiting; /* 有线程正在等待，其他线程添加更早的定时器时需要唤醒 */
+	EasyTaskQueue_t tasks; /* 其他线程投递的任务 */
+	int spinUs; /* 忙轮询时间(us)，0表示不自旋 */
+	int spinAdaptive; /* 按事件到达间隔调整自旋时间 */
+	long long lastArrival; /* 上次等到事件的时间(ns)，自适应时使用 */
+	long long arrivalGap; /* 事件到达间隔的平滑值(ns)，0表示还没有 */
+	int spinMisses; /* 连续自旋落空的次数 */
+	unsigned int spinSkips; /* 连续落空后跳过自旋的计数 */
+	EasyStats_t stats; /* 等待和忙轮询计数(不含唤醒fd)，其他计数在后端 */
 }Poller_t;
 
+#define POLLER_TASK_BATCH 1024 /* 每次等待最多执行的任务数，剩余的下次执行 */
+#define POLLER_SPIN_MISSES 8 /* 自适应时连续落空这么多次后停止自旋 */
+#define POLLER_SPIN_PROBE 64 /* 停止自旋后每这么多次等待再试一次 */
+
+/*
+ * 唤醒原因
+ */
+#define POLLER_WOKEN_TIMER 1 /* 只因定时器变化被唤醒，重新计算等待时间即可 */
+#define POLLER_WOKEN_USER 2 /* 被用户唤醒或有投递的任务 */
+
+/*
+ * 单调时钟(ms)
+ */
+static long long PollerNow(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * 打开唤醒fd，优先使用eventfd，不支持时使用管道
+ * return：0 on success，-1 on fail
+ */
+static int PollerWakeOpen(Poller_t *ep)
+{
+	int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd >= 0)
+	{
+		ep->wakeFd[0] = ep->wakeFd[1] = fd;
+		return 0;
+	}
+
+	return pipe2(ep->wakeFd, O_NONBLOCK | O_CLOEXEC);
+}
+
+/*
+ * 关闭唤醒fd
+ */
+static void PollerWakeClose(Poller_t *ep)
+{
+	if (ep->wakeFd[1] != ep->wakeFd[0])
+		close(ep->wakeFd[1]);
+	close(ep->wakeFd[0]);
+	ep->wakeFd[0] = ep->wakeFd[1] = -1;
+}
+
+/*
+ * 唤醒等待线程，上次唤醒尚未被处理时不再写入
+ * user：是否需要等待返回
+ */
+static void PollerWakeSignal(Poller_t *ep, int user)
+{
+	if (user)
+		__atomic_store_n(&ep->wakeUser, 1, __ATOMIC_SEQ_CST);
+
+	uint64_t one = 1;
+
+	if (__atomic_exchange_n(&ep->wakePending, 1, __ATOMIC_SEQ_CST))
+		return;
+
+	/* 写满(管道)说明已经可读，忽略失败 */
+	if (ep->wakeFd[1] == ep->wakeFd[0])
+		(void)!write(ep->wakeFd[1], &one, sizeof(one));
+	else
+		(void)!write(ep->wakeFd[1], &one, 1);
+}
+
+/*
+ * 执行投递的任务，只在等待线程中调用
+ */
+static void PollerRunTasks(Poller_t *ep)
+{
+	EasyTask_t *task = NULL;
+	int i = 0;
+
+	for (; i < POLLER_TASK_BATCH && (task = TaskQueuePop(&ep->tasks)) != NULL; i++)
+	{
+		task->func(task->arg);
+		free(task);
+	}
+
+	if (i == POLLER_TASK_BATCH) /* 还有剩余，保证下次等待不阻塞 */
+		PollerWakeSignal(ep, 1);
+}
+
+/*
+ * 清空唤醒fd并执行投递的任务
+ * return：唤醒原因，POLLER_WOKEN_XXX
+ */
+static int PollerWakeHandle(Poller_t *ep)
+{
+	char buf[64];
+
+	while (read(ep->wakeFd[0], buf, sizeof(buf)) > 0)
+		;
+
+	/* 先清除标志再取任务：之后投递的任务一定会再次唤醒；交换操作保证看到清除前投递的任务 */
+	__atomic_exchange_n(&ep->wakePending, 0, __ATOMIC_SEQ_CST);
+	int wake = __atomic_exchange_n(&ep->wakeUser, 0, __ATOMIC_SEQ_CST) ? POLLER_WOKEN_USER : POLLER_WOKEN_TIMER;
+	PollerRunTasks(ep);
+
+	return wake;
+}
+
+/*
+ * 从返回的事件中去掉唤醒fd，被唤醒时清空唤醒fd并执行投递的任务
+ * woken：唤醒原因，POLLER_WOKEN_XXX
+ * return：剩余的事件个数
+ */
+static int PollerWakeFilter(Poller_t *ep, EasyEvent_t *events, int nums, int *woken)
+{
+	int i = 0, k = 0, wake = 0;
+
+	for (; i < nums; i++)
+	{
+		if (events[i].fd == ep->wakeFd[0])
+		{
+			wake = 1;
+			continue;
+		}
+
+		if (k != i)
+			events[k] = events[i];
+		k++;
+	}
+
+	if (wake)
+	{
+		wake = PollerWakeHandle(ep);
+		if (wake > *woken)
+			*woken = wake;
+	}
+
+	return k;
+}
+
 /*
  * 创建Poller监听器
- * size：待监听的文件fd数量
+ * size：预计监听的文件fd数量，超出时自动扩容
  * return：new handle on success，NULL on fail
  */
 PollerHandle PollerCreate(PollerType_e type, int size)
+{
+	PollerOptions_t options;
+
+	options.size = size;
+	options.flags = 0;
+
+	return PollerCreateEx(type, &options);
+}
+
+/*
+ * 按参数创建Poller监听器
+ * options：创建参数，NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+PollerHandle PollerCreateEx(PollerType_e type, const PollerOptions_t *options)
 {
 	Poller_t *ep = (Poller_t *)malloc(sizeof(Poller_t));
 	if (!ep)
 		return NULL;
 
+#ifdef EASY_POLLER_PIN_EPOLL
+	if (type != PT_EPOLLER) /* 只编译了epoll */
+	{
+		free(ep);
+		return NULL;
+	}
+	ep->ops = &EPOLL_OPS;
+#else
 	switch (type)
 	{
 	case PT_EPOLLER:
-		ep->type = PT_EPOLLER;
-		ep->poller = EpollCreate(size);
+		ep->ops = &EPOLL_OPS;
 		break;
 
 	case PT_POLLER:
-		ep->type = PT_POLLER;
-		ep->poller = PollCreate(size);
+		ep->ops = &POLL_OPS;
+		break;
+
+	case PT_URING:
+		ep->ops = &URING_OPS;
 		break;
 
 	default:
-		ep->type = PT_SELECTOR;
-		ep->poller = SelectCreate(size);
+		type = PT_SELECTOR;
+		ep->ops = &SELECT_OPS;
 	}
+#endif
+
+	ep->type = type;
+	ep->poller = POLLER_OPS(ep)->create(options);
 
 	if (!ep->poller)
 	{
 		free(ep);
-		ep = NULL;
+		return NULL;
 	}
 
-	return ep;
+	TimerWheelInit(&ep->timers, PollerNow());
+	EasyLockInit(&ep->lock, !(options && (options->flags & POLLER_FLAG_NOLOCK)));
+	EasyLockTiming(&ep->lock, options && (options->flags & POLLER_FLAG_STATS_TIME));
+	TaskQueueInit(&ep->tasks);
+	ep->wakePending = 0;
+	ep->wakeUser = 0;
+	ep->waiting = 0;
+	ep->wakeFd[0] = ep->wakeFd[1] = -1;
+	ep->spinUs = 0;
+	ep->spinAdaptive = 0;
+	ep->lastArrival = 0;
+	ep->arrivalGap = 0;
+	ep->spinMisses = 0;
+	ep->spinSkips = 0;
+	StatsInit(&ep->stats, options);
+
+	/* 唤醒fd和普通fd一样注册，返回前过滤掉 */
+	EasyEvent_t wake;
+	memset(&wake, 0, sizeof(wake));
+	if (PollerWakeOpen(ep) == 0)
+	{
+		wake.fd = ep->wakeFd[0];
+		wake.event = EVENT_READ;
+		if (PollerAddEvent(ep, &wake) == 0)
+			return ep;
+	}
+
+	PollerDestroy(ep);
+	return NULL;
 }
 
 /*
@@ -66,18 +346,146 @@ void PollerDestroy(PollerHandle handle)
 	if (!ep)
 		return;
 
-	if (ep->type == PT_EPOLLER)
-		EpollDestroy(ep->poller);
-	else if (ep->type == PT_POLLER)
-		PollDestroy(ep->poller);
-	else if (ep->type == PT_SELECTOR)
-		SelectDestroy(ep->poller);
+	POLLER_OPS(ep)->destroy(ep->poller);
+
+	TimerWheelDestroy(&ep->timers);
+	EasyLockDestroy(&ep->lock);
+
+	/* 未执行的任务直接丢弃 */
+	EasyTask_t *task = NULL;
+	while ((task = TaskQueuePop(&ep->tasks)) != NULL)
+		free(task);
+
+	if (ep->wakeFd[0] >= 0)
+		PollerWakeClose(ep);
 
 	free(ep);
 }
 
+/*
+ * 记录一次等待，后端的计数包括唤醒fd，这里按过滤后的个数另行统计
+ * nums：返回给调用者的事件个数，只被唤醒时为0
+ */
+static void PollerWaitStats(Poller_t *ep, int nums)
+{
+	StatsAdd(&ep->stats, &ep->stats.s.waits, 1);
+	StatsBatch(&ep->stats, nums);
+}
+
+/*
+ * 在底层Poller上等待，返回前过滤唤醒fd
+ * woken：唤醒原因，POLLER_WOKEN_XXX
+ */
+static int PollerWaitOnce(Poller_t *ep, EasyEvent_t *events, int maxevents, int timeout, int *woken)
+{
+	int ret = POLLER_OPS(ep)->wait(ep->poller, events, maxevents, timeout);
+	if (ret > 0)
+		ret = PollerWakeFilter(ep, events, ret, woken);
+
+	return ret;
+}
+
+/*
+ * 记录一次等到事件的时间，更新到达间隔的平滑值(1/8权重)
+ * 多个线程同时等待时不加锁，只是近似值
+ */
+static void PollerArrival(Poller_t *ep, long long now)
+{
+	long long last = __atomic_exchange_n(&ep->lastArrival, now, __ATOMIC_RELAXED);
+	long long gap = __atomic_load_n(&ep->arrivalGap, __ATOMIC_RELAXED);
+	if (last <= 0 || now <= last)
+		return;
+
+	gap = gap ? gap + (now - last - gap) / 8 : (now - last);
+	__atomic_store_n(&ep->arrivalGap, gap, __ATOMIC_RELAXED);
+}
+
+/*
+ * 自旋等到了事件
+ */
+static void PollerSpinHit(Poller_t *ep, long long now)
+{
+	StatsAdd(&ep->stats, &ep->stats.s.spinHits, 1);
+	__atomic_store_n(&ep->spinMisses, 0, __ATOMIC_RELAXED);
+	PollerArrival(ep, now);
+}
+
+/*
+ * 自旋落空，转为阻塞
+ */
+static void PollerSpinMiss(Poller_t *ep)
+{
+	StatsAdd(&ep->stats, &ep->stats.s.spinBlocks, 1);
+	__atomic_fetch_add(&ep->spinMisses, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * 本次等待的自旋时间(ns)
+ * 自适应时取到达间隔的两倍，间隔比自旋上限还长时自旋多半白费，直接阻塞；
+ * 连续落空(例如发送方与本线程共用一个CPU，自旋时对方无法运行)时停止自旋，只偶尔再试
+ */
+static long long PollerSpinBudget(Poller_t *ep)
+{
+	long long budget = (long long)__atomic_load_n(&ep->spinUs, __ATOMIC_RELAXED) * 1000;
+	if (budget <= 0 || !__atomic_load_n(&ep->spinAdaptive, __ATOMIC_RELAXED))
+		return budget;
+
+	if (__atomic_load_n(&ep->spinMisses, __ATOMIC_RELAXED) >= POLLER_SPIN_MISSES
+		&& (__atomic_add_fetch(&ep->spinSkips, 1, __ATOMIC_RELAXED) % POLLER_SPIN_PROBE) != 0)
+		return 0;
+
+	long long gap = __atomic_load_n(&ep->arrivalGap, __ATOMIC_RELAXED);
+	if (gap <= 0) /* 还没有数据，按上限自旋 */
+		return budget;
+	if (gap > budget)
+		return 0;
+
+	return (gap * 2 < budget) ? gap * 2 : budget;
+}
+
+/*
+ * 等待后端事件，开启忙轮询时先以0超时反复等待，超过自旋时间仍没有事件再阻塞
+ * 落空的自旋探测只计入spinBlocks，不算作等待
+ * timeout：超时时间(ms)，自旋用掉的时间从中扣除
+ */
+static int PollerWaitBackend(Poller_t *ep, EasyEvent_t *events, int maxevents, int timeout, int *woken)
+{
+	long long budget = (timeout != 0) ? PollerSpinBudget(ep) : 0;
+	long long begin = 0, now = 0;
+	int ret = 0;
+
+	if (budget > 0)
+	{
+		begin = StatsNow();
+		do
+		{
+			ret = PollerWaitOnce(ep, events, maxevents, 0, woken);
+			now = StatsNow();
+			if (ret != 0 || *woken) /* 等到事件、出错或被唤醒 */
+			{
+				if (ret > 0)
+					PollerSpinHit(ep, now);
+				PollerWaitStats(ep, ret);
+				return ret;
+			}
+		} while (now - begin < budget);
+
+		PollerSpinMiss(ep);
+		if (timeout > 0)
+			timeout = (timeout > (now - begin) / 1000000) ? (int)(timeout - (now - begin) / 1000000) : 0;
+	}
+
+	ret = PollerWaitOnce(ep, events, maxevents, timeout, woken);
+	if (ret > 0 && __atomic_load_n(&ep->spinAdaptive, __ATOMIC_RELAXED))
+		PollerArrival(ep, StatsNow());
+
+	PollerWaitStats(ep, ret);
+	return ret;
+}
+
 /*
  * 监听事件
+ * 有定时器时等待时间不超过最近的到期时间，到期的定时器以EVENT_TIMER事件返回
  * handle：Poller句柄
  * events：保存触发的事件数组
  * maxevents：events数组大小
@@ -87,18 +495,74 @@ void PollerDestroy(PollerHandle handle)
 int PollerWaitEvent(PollerHandle handle, EasyEvent_t *events, int maxevents, int timeout)
 {
 	Poller_t *ep = (Poller_t *)handle;
-	if (!ep)
+	if (!ep || !events || (maxevents < 1))
 		return -1;
 
-	int ret = -1;
-	if (ep->type == PT_EPOLLER)
-		ret = EpollWaitEvent(ep->poller, events, maxevents, timeout);
-	else if (ep->type == PT_POLLER)
-		ret = PollWaitEvent(ep->poller, events, maxevents, timeout);
-	else if (ep->type == PT_SELECTOR)
-		ret = SelectWaitEvent(ep->poller, events, maxevents, timeout);
+	long long start = 0, now = 0, next = 0;
+	int nums = 0, ret = 0, wait = 0, bounded = 0, woken = 0;
 
-	return ret;
+	if (ep->lock.enabled) /* 其他线程添加定时器时可能被唤醒，需要起始时间 */
+		start = PollerNow();
+
+	EasyLock(&ep->lock);
+	int count = ep->timers.count;
+	ep->waiting = 1;
+	EasyUnlock(&ep->lock);
+
+	if (count == 0) /* 没有定时器 */
+	{
+		ret = PollerWaitBackend(ep, events, maxevents, timeout, &woken);
+		if (ret != 0 || woken != POLLER_WOKEN_TIMER)
+		{
+			__atomic_store_n(&ep->waiting, 0, __ATOMIC_RELAXED);
+			return ret;
+		}
+	}
+
+	if (!ep->lock.enabled)
+		start = PollerNow();
+
+	for (;;)
+	{
+		now = PollerNow();
+
+		EasyLock(&ep->lock);
+		nums = TimerWheelExpire(&ep->timers, now, events, maxevents);
+		next = TimerWheelNext(&ep->timers);
+		ep->waiting = (nums == 0);
+		EasyUnlock(&ep->lock);
+
+		if (nums > 0) /* 有到期的定时器，顺便收集已就绪的fd */
+		{
+			if (nums < maxevents)
+			{
+				ret = PollerWaitBackend(ep, events + nums, maxevents - nums, 0, &woken);
+				if (ret > 0)
+					nums += ret;
+			}
+			return nums;
+		}
+
+		/* 等待时间取用户超时与最近到期时间的较小值 */
+		wait = timeout;
+		if (timeout >= 0)
+			wait = (start + timeout > now) ? (int)(start + timeout - now) : 0;
+
+		bounded = 0;
+		if (next >= 0 && (wait < 0 || next - now < wait))
+		{
+			wait = (next > now) ? (int)(next - now) : 0;
+			bounded = 1;
+		}
+
+		woken = 0;
+		ret = PollerWaitBackend(ep, events, maxevents, wait, &woken);
+		if (ret != 0 || woken == POLLER_WOKEN_USER || (!bounded && !woken)) /* fd就绪、出错、被用户唤醒或用户超时 */
+		{
+			__atomic_store_n(&ep->waiting, 0, __ATOMIC_RELAXED);
+			return ret;
+		}
+	}
 }
 
 /*
@@ -113,15 +577,24 @@ int PollerAddEvent(PollerHandle handle, const EasyEvent_t *event)
 	if (!ep)
 		return -1;
 
-	int ret = -1;
-	if (ep->type == PT_EPOLLER)
-		ret = EpollAddEvent(ep->poller, event);
-	else if (ep->type == PT_POLLER)
-		ret = PollAddEvent(ep->poller, event);
-	else if (ep->type == PT_SELECTOR)
-		ret = SelectAddEvent(ep->poller, event);
+	return POLLER_OPS(ep)->add(ep->poller, event);
+}
 
-	return ret;
+/*
+ * 批量添加事件，只加一次锁
+ * handle：Poller句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollerAddEvents(PollerHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep)
+		return -1;
+
+	return POLLER_OPS(ep)->adds(ep->poller, events, count, results);
 }
 
 /*
@@ -136,15 +609,24 @@ int PollerUpdateEvent(PollerHandle handle, const EasyEvent_t *event)
 	if (!ep)
 		return -1;
 
-	int ret = -1;
-	if (ep->type == PT_EPOLLER)
-		ret = EpollUpdateEvent(ep->poller, event);
-	else if (ep->type == PT_POLLER)
-		ret = PollUpdateEvent(ep->poller, event);
-	else if (ep->type == PT_SELECTOR)
-		ret = SelectUpdateEvent(ep->poller, event);
+	return POLLER_OPS(ep)->update(ep->poller, event);
+}
 
-	return ret;
+/*
+ * 批量更新事件，只加一次锁
+ * handle：Poller句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollerUpdateEvents(PollerHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep)
+		return -1;
+
+	return POLLER_OPS(ep)->updates(ep->poller, events, count, results);
 }
 
 /*
@@ -159,14 +641,333 @@ int PollerRemoveEvent(PollerHandle handle, const EasyEvent_t *event)
 	if (!ep)
 		return -1;
 
-	int ret = -1;
+	return POLLER_OPS(ep)->remove(ep->poller, event);
+}
+
+/*
+ * 批量删除事件，只加一次锁
+ * handle：Poller句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollerRemoveEvents(PollerHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep)
+		return -1;
+
+	return POLLER_OPS(ep)->removes(ep->poller, events, count, results);
+}
+
+/*
+ * 重新激活事件
+ * handle：Poller句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int PollerRearmEvent(PollerHandle handle, const EasyEvent_t *event)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep)
+		return -1;
+
+	return POLLER_OPS(ep)->rearm(ep->poller, event);
+}
+
+/*
+ * 添加定时器
+ * handle：Poller句柄
+ * timeout：超时时间(ms)
+ * userData：到期时随EVENT_TIMER事件返回
+ * return：定时器id(>0)，失败返回-1
+ */
+long long PollerAddTimer(PollerHandle handle, int timeout, void *userData)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep || (timeout < 0))
+		return -1;
+
+	long long now = PollerNow();
+
+	EasyLock(&ep->lock);
+	long long next = TimerWheelNext(&ep->timers);
+	long long id = TimerWheelAdd(&ep->timers, now, now + timeout, userData);
+	int waiting = ep->waiting;
+	EasyUnlock(&ep->lock);
+
+	/* 其他线程正在按原来的到期时间等待 */
+	if (id > 0 && waiting && (next < 0 || now + timeout < next))
+		PollerWakeSignal(ep, 0);
+
+	return id;
+}
+
+/*
+ * 删除定时器
+ * handle：Poller句柄
+ * timerId：PollerAddTimer()返回的id
+ * return：0 on success，-1 on fail(不存在或已到期)
+ */
+int PollerCancelTimer(PollerHandle handle, long long timerId)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep)
+		return -1;
+
+	EasyLock(&ep->lock);
+	int ret = TimerWheelCancel(&ep->timers, timerId);
+	EasyUnlock(&ep->lock);
+
+	return ret;
+}
+
+/*
+ * 唤醒正在PollerWaitEvent()中等待的线程，没有在等待时下次等待立即返回
+ * handle：Poller句柄
+ * return：0 on success，-1 on fail
+ */
+int PollerWakeup(PollerHandle handle)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep)
+		return -1;
+
+	PollerWakeSignal(ep, 1);
+	return 0;
+}
+
+/*
+ * 投递任务，在等待线程下次从PollerWaitEvent()返回前执行
+ * handle：Poller句柄
+ * func：任务函数
+ * arg：任务参数
+ * return：0 on success，-1 on fail
+ */
+int PollerPostTask(PollerHandle handle, EasyTaskFunc func, void *arg)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep || !func)
+		return -1;
+
+	EasyTask_t *task = (EasyTask_t *)malloc(sizeof(EasyTask_t));
+	if (!task)
+		return -1;
+
+	task->func = func;
+	task->arg = arg;
+	TaskQueuePush(&ep->tasks, task);
+	PollerWakeSignal(ep, 1);
+	return 0;
+}
+
+/*
+ * 获取性能计数
+ * handle：Poller句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int PollerGetStats(PollerHandle handle, PollerStats_t *stats)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep || !stats)
+		return -1;
+
+	if (POLLER_OPS(ep)->stats(ep->poller, stats) < 0)
+		return -1;
+
+	/* 定时器锁与后端的锁分开统计，这里合并；等待计数以过滤唤醒fd后的为准 */
+	stats->lockHeldNs += EasyLockHeldNs(&ep->lock);
+	stats->waits = __atomic_load_n(&ep->stats.s.waits, __ATOMIC_RELAXED);
+	stats->emptyWaits = __atomic_load_n(&ep->stats.s.emptyWaits, __ATOMIC_RELAXED);
+	stats->events = __atomic_load_n(&ep->stats.s.events, __ATOMIC_RELAXED);
+	stats->maxBatch = __atomic_load_n(&ep->stats.s.maxBatch, __ATOMIC_RELAXED);
+	stats->spinHits = __atomic_load_n(&ep->stats.s.spinHits, __ATOMIC_RELAXED);
+	stats->spinBlocks = __atomic_load_n(&ep->stats.s.spinBlocks, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/*
+ * 设置忙轮询
+ * handle：Poller句柄
+ * options：忙轮询参数，NULL表示全部关闭
+ * return：0 on success，-1 on fail(参数错误，或要求内核忙轮询但不支持，此时自旋设置仍然生效)
+ */
+int PollerSetBusyPoll(PollerHandle handle, const PollerBusyPoll_t *options)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!ep)
+		return -1;
+
+	int spinUs = (options && options->spinUs > 0) ? options->spinUs : 0;
+	__atomic_store_n(&ep->spinUs, spinUs, __ATOMIC_RELAXED);
+	__atomic_store_n(&ep->spinAdaptive, options ? !!options->adaptive : 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&ep->spinMisses, 0, __ATOMIC_RELAXED);
+
+	if (options && options->kernelUs > 0)
+	{
+		if (!POLLER_OPS(ep)->busyPoll)
+			return -1;
+		return POLLER_OPS(ep)->busyPoll(ep->poller, options->kernelUs, options->kernelBudget);
+	}
+
+	/* 关闭之前设置的内核忙轮询，不支持时忽略 */
+	if (POLLER_OPS(ep)->busyPoll)
+		POLLER_OPS(ep)->busyPoll(ep->poller, 0, 0);
+	return 0;
+}
+
+/*
+ * 初始化事件游标
+ * cursor：游标
+ * handle：Poller句柄
+ * capacity：每次等待最多取的事件个数
+ * return：0 on success，-1 on fail
+ */
+int PollerCursorInit(PollerCursor_t *cursor, PollerHandle handle, int capacity)
+{
+	Poller_t *ep = (Poller_t *)handle;
+	if (!cursor || !ep || (capacity < 1))
+		return -1;
+
+	memset(cursor, 0, sizeof(PollerCursor_t));
+	cursor->handle = handle;
+	cursor->capacity = capacity;
+	cursor->index = -1;
+	cursor->wakeFd = ep->wakeFd[0];
+
+	cursor->events = (EasyEvent_t *)malloc(capacity * sizeof(EasyEvent_t));
+	if (ep->type == PT_EPOLLER)
+		cursor->native = (struct epoll_event *)malloc(capacity * sizeof(struct epoll_event));
+
+	if (!cursor->events || (ep->type == PT_EPOLLER && !cursor->native))
+	{
+		PollerCursorDestroy(cursor);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * 释放事件游标的缓冲区
+ */
+void PollerCursorDestroy(PollerCursor_t *cursor)
+{
+	if (!cursor)
+		return;
+
+	if (cursor->native)
+		free(cursor->native);
+	cursor->native = NULL;
+
+	if (cursor->events)
+		free(cursor->events);
+	cursor->events = NULL;
+
+	cursor->count = 0;
+	cursor->index = -1;
+}
+
+/*
+ * 原生事件中除唤醒fd外的个数
+ */
+static int PollerNativeCount(Poller_t *ep, const struct epoll_event *native, int nums)
+{
+	int i = 0, count = nums;
+
+	for (; i < nums; i++)
+	{
+		if (((EasyFdEntry_t *)native[i].data.ptr)->fd == ep->wakeFd[0])
+			count--;
+	}
+
+	return count;
+}
+
+/*
+ * 用游标监听事件
+ * cursor：已初始化的游标
+ * timeout：超时时间(ms)
+ * return：取到的事件个数，失败返回-1
+ */
+int PollerWaitCursor(PollerCursor_t *cursor, int timeout)
+{
+	if (!cursor || !cursor->handle || !cursor->events)
+		return -1;
+
+	Poller_t *ep = (Poller_t *)cursor->handle;
+	int ret = -1, failed = 0;
+
+	cursor->count = 0;
+	cursor->index = -1;
+	cursor->isNative = 0;
+
 	if (ep->type == PT_EPOLLER)
-		ret = EpollRemoveEvent(ep->poller, event);
-	else if (ep->type == PT_POLLER)
-		ret = PollRemoveEvent(ep->poller, event);
-	else if (ep->type == PT_SELECTOR)
-		ret = SelectRemoveEvent(ep->poller, event);
+	{
+		EasyLock(&ep->lock);
+		int count = ep->timers.count;
+		ep->waiting = (count == 0);
+		EasyUnlock(&ep->lock);
+
+		if (count == 0) /* 没有定时器，直接取原生事件 */
+		{
+			long long budget = (timeout != 0) ? PollerSpinBudget(ep) : 0;
+			long long begin = budget ? StatsNow() : 0, now = begin;
+			int real = 0; /* 除唤醒fd外的事件个数 */
+
+			/* 忙轮询同PollerWaitBackend()，唤醒fd由调用者处理 */
+			while (budget > 0)
+			{
+				ret = EpollWaitNative(ep->poller, cursor->native, cursor->capacity, 0, cursor->events, &failed);
+				now = StatsNow();
+				real = PollerNativeCount(ep, cursor->native, ret);
+				if (real > 0) /* 只有唤醒fd不算等到事件 */
+					PollerSpinHit(ep, now);
+				if (ret != 0 || failed > 0)
+					break;
+				if (now - begin >= budget)
+				{
+					PollerSpinMiss(ep);
+					if (timeout > 0)
+						timeout = (timeout > (now - begin) / 1000000) ? (int)(timeout - (now - begin) / 1000000) : 0;
+					budget = 0;
+				}
+			}
 
+			if (budget == 0)
+			{
+				ret = EpollWaitNative(ep->poller, cursor->native, cursor->capacity, timeout, cursor->events, &failed);
+				real = PollerNativeCount(ep, cursor->native, ret);
+				if (real > 0 && __atomic_load_n(&ep->spinAdaptive, __ATOMIC_RELAXED))
+					PollerArrival(ep, StatsNow());
+			}
+			__atomic_store_n(&ep->waiting, 0, __ATOMIC_RELAXED);
+			PollerWaitStats(ep, failed ? failed : real);
+			if (ret < 0)
+				return -1;
+
+			cursor->isNative = (failed == 0);
+			cursor->count = failed ? failed : ret;
+			return cursor->count;
+		}
+	}
+
+	ret = PollerWaitEvent(ep, cursor->events, cursor->capacity, timeout);
+	if (ret < 0)
+		return -1;
+
+	cursor->count = ret;
 	return ret;
 }
 
+/*
+ * 处理唤醒fd：清空并执行投递的任务
+ */
+void PollerCursorWake(PollerCursor_t *cursor)
+{
+	if (cursor && cursor->handle)
+		PollerWakeHandle((Poller_t *)cursor->handle);
+}
+
@@ -1,12 +1,15 @@
 /*
- * 3种POLL封装声明
+ * 4种POLL封装声明
  * Copyright FreeCode. All Rights Reserved.
  * MIT License (https://opensource.org/licenses/MIT)
  * 2025 by liuqingshuige
  */
 #ifndef __FREE_EASY_POLLER_H__
 #define __FREE_EASY_POLLER_H__
+#include <stddef.h>
+#include <sys/epoll.h>
 #include "easy_event.h"
+#include "easy_registry.h"
 
 typedef void *PollerHandle;
 
@@ -14,9 +17,27 @@ typedef enum PollerType_e
 {
 	PT_EPOLLER,
 	PT_POLLER,
-	PT_SELECTOR
+	PT_SELECTOR,
+	PT_URING /* io_uring，需要5.13以上内核，不支持或被禁用时创建失败 */
 }PollerType_e;
 
+/*
+ * 事件游标：缓冲区由游标持有并重复使用，每个等待线程一个
+ * PT_EPOLLER且没有定时器时直接遍历内核返回的原生事件，不拷贝、不转换；
+ * 其他情况(其他类型、有定时器、提交失败)遍历转换后的EasyEvent_t
+ */
+typedef struct PollerCursor_t
+{
+	PollerHandle handle; /* 所属Poller */
+	struct epoll_event *native; /* 原生事件 */
+	EasyEvent_t *events; /* 转换后的事件 */
+	int capacity; /* 两个数组的大小 */
+	int count; /* 本次等待取到的事件个数 */
+	int index; /* 当前事件下标 */
+	int isNative; /* 本次是否为原生事件 */
+	int wakeFd; /* 唤醒fd，遍历原生事件时跳过 */
+}PollerCursor_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -24,11 +45,22 @@ extern "C"
 
 /*
  * 创建Poller监听器
- * size：待监听的文件fd数量
+ * size：预计监听的文件fd数量，超出时自动扩容
  * return：new handle on success，NULL on fail
  */
 PollerHandle PollerCreate(PollerType_e type, int size);
 
+/*
+ * 按参数创建Poller监听器
+ * options：创建参数，NULL表示使用默认参数
+ *   flags包含POLLER_FLAG_NOLOCK时不加锁，Poller的所有调用必须在同一线程中进行
+ *   flags包含POLLER_FLAG_CHANGELIST时，epoll的添加/更新/删除只在用户态记录，
+ *   PollerWaitEvent()阻塞前合并后再调用epoll_ctl，抵消的变更(如添加后又删除)不产生系统调用；
+ *   提交失败的fd会从Poller中移除，并以EVENT_ERROR事件从PollerWaitEvent()返回
+ * return：new handle on success，NULL on fail
+ */
+PollerHandle PollerCreateEx(PollerType_e type, const PollerOptions_t *options);
+
 /*
  * 销毁Poller监听器
  * handle：PollerCreate()返回的句柄
@@ -37,6 +69,8 @@ void PollerDestroy(PollerHandle handle);
 
 /*
  * 监听事件
+ * 有定时器时等待时间不超过最近的到期时间，到期的定时器以EVENT_TIMER事件(fd为-1)返回
+ * 被PollerWakeup()/PollerPostTask()唤醒时先执行投递的任务，没有其他事件时提前返回0
  * handle：Poller句柄
  * events：保存触发的事件数组
  * maxevents：events数组大小
@@ -53,6 +87,16 @@ int PollerWaitEvent(PollerHandle handle, EasyEvent_t *events, int maxevents, int
  */
 int PollerAddEvent(PollerHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量添加事件，只加一次锁，适合大量连接同时建立或关闭
+ * handle：Poller句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollerAddEvents(PollerHandle handle, const EasyEvent_t *events, int count, int *results);
+
 /*
  * 更新事件
  * handle：Poller句柄
@@ -61,6 +105,16 @@ int PollerAddEvent(PollerHandle handle, const EasyEvent_t *event);
  */
 int PollerUpdateEvent(PollerHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量更新事件，只加一次锁，适合大量连接同时建立或关闭
+ * handle：Poller句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollerUpdateEvents(PollerHandle handle, const EasyEvent_t *events, int count, int *results);
+
 /*
  * 删除事件
  * handle：Poller句柄
@@ -69,13 +123,177 @@ int PollerUpdateEvent(PollerHandle handle, const EasyEvent_t *event);
  */
 int PollerRemoveEvent(PollerHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量删除事件，只加一次锁，适合大量连接同时建立或关闭
+ * handle：Poller句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollerRemoveEvents(PollerHandle handle, const EasyEvent_t *events, int count, int *results);
 
+/*
+ * 重新激活事件
+ * EVENT_EDGE/EVENT_ONESHOT事件报告后，按注册时的事件重新激活，无需再传入事件
+ * handle：Poller句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int PollerRearmEvent(PollerHandle handle, const EasyEvent_t *event);
 
-#ifdef __cplusplus
+/*
+ * 添加定时器，到期一次后自动删除
+ * 由分层时间轮管理，添加/删除O(1)，适合大量连接的空闲超时
+ * 其他线程添加的定时器早于当前最近的到期时间时唤醒等待线程(POLLER_FLAG_NOLOCK时只能在等待线程中添加)
+ * handle：Poller句柄
+ * timeout：超时时间(ms)
+ * userData：到期时随EVENT_TIMER事件返回
+ * return：定时器id(>0)，失败返回-1
+ */
+long long PollerAddTimer(PollerHandle handle, int timeout, void *userData);
+
+/*
+ * 删除定时器
+ * handle：Poller句柄
+ * timerId：PollerAddTimer()返回的id
+ * return：0 on success，-1 on fail(不存在或已到期)
+ */
+int PollerCancelTimer(PollerHandle handle, long long timerId);
+
+/*
+ * 唤醒正在PollerWaitEvent()中等待的线程，没有在等待时下次等待立即返回
+ * 连续多次唤醒在被处理前只写一次唤醒fd；任意线程可调用，包括POLLER_FLAG_NOLOCK时
+ * handle：Poller句柄
+ * return：0 on success，-1 on fail
+ */
+int PollerWakeup(PollerHandle handle);
+
+/*
+ * 投递任务，在等待线程下次从PollerWaitEvent()返回前执行
+ * 无锁队列，投递只有一次原子交换；任意线程可调用，包括POLLER_FLAG_NOLOCK时
+ * 同一线程投递的任务按顺序执行；Poller销毁时未执行的任务直接丢弃
+ * handle：Poller句柄
+ * func：任务函数
+ * arg：任务参数
+ * return：0 on success，-1 on fail
+ */
+int PollerPostTask(PollerHandle handle, EasyTaskFunc func, void *arg);
+
+/*
+ * 获取性能计数，任意线程可调用
+ * 各计数分别读取，不保证相互一致；waits/emptyWaits/events/maxBatch不计内部唤醒fd的事件
+ * blockedNs/lockHeldNs需要创建时指定POLLER_FLAG_STATS_TIME，否则为0
+ * handle：Poller句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int PollerGetStats(PollerHandle handle, PollerStats_t *stats);
+
+/*
+ * 设置忙轮询，任意线程可调用，下次等待生效
+ * 设置spinUs后，超时不为0的等待先以0超时反复等待，最多spinUs微秒，仍没有事件再阻塞，
+ * 省去阻塞/唤醒的开销，代价是自旋期间占满CPU；adaptive时按最近的到达间隔缩短或跳过自旋，连续落空时停止自旋
+ * kernelUs只对epoll有效，内核在epoll_wait中直接轮询网卡队列(需要NAPI忙轮询和内核6.9以上)
+ * 自旋的效果见PollerGetStats()的spinHits/spinBlocks
+ * handle：Poller句柄
+ * options：忙轮询参数，NULL表示全部关闭
+ * return：0 on success，-1 on fail(参数错误，或要求内核忙轮询但不支持，此时自旋设置仍然生效)
+ */
+int PollerSetBusyPoll(PollerHandle handle, const PollerBusyPoll_t *options);
+
+/*
+ * 初始化事件游标
+ * cursor：游标
+ * handle：Poller句柄
+ * capacity：每次等待最多取的事件个数
+ * return：0 on success，-1 on fail
+ */
+int PollerCursorInit(PollerCursor_t *cursor, PollerHandle handle, int capacity);
+
+/*
+ * 释放事件游标的缓冲区
+ */
+void PollerCursorDestroy(PollerCursor_t *cursor);
+
+/*
+ * 用游标监听事件，之后用PollerCursorNext()遍历
+ * cursor：已初始化的游标
+ * timeout：超时时间(ms)
+ * return：取到的事件个数(原生事件中可能包含遍历时跳过的)，失败返回-1
+ */
+int PollerWaitCursor(PollerCursor_t *cursor, int timeout);
+
+/*
+ * 处理唤醒fd：清空并执行投递的任务，由PollerCursorNext()调用
+ */
+void PollerCursorWake(PollerCursor_t *cursor);
+
+/*
+ * 移动到下一个事件，跳过唤醒fd；原生事件中还跳过等待返回后已被删除的fd
+ * return：1表示有事件，0表示遍历结束
+ */
+static inline int PollerCursorNext(PollerCursor_t *cursor)
+{
+	EasyFdEntry_t *entry = NULL;
+
+	while (++cursor->index < cursor->count)
+	{
+		if (!cursor->isNative)
+			return 1;
+
+		entry = (EasyFdEntry_t *)cursor->native[cursor->index].data.ptr;
+		if (entry->slot < 0) /* 返回后已被删除 */
+			continue;
+
+		if (entry->fd == cursor->wakeFd)
+		{
+			PollerCursorWake(cursor);
+			continue;
+		}
+
+		return 1;
+	}
+
+	return 0;
 }
-#endif
 
-#endif
+/*
+ * 当前事件的fd，定时器为-1
+ */
+static inline int PollerCursorFd(const PollerCursor_t *cursor)
+{
+	if (cursor->isNative)
+		return ((EasyFdEntry_t *)cursor->native[cursor->index].data.ptr)->fd;
+	return cursor->events[cursor->index].fd;
+}
 
+/*
+ * 当前事件的用户数据
+ */
+static inline void *PollerCursorUserData(const PollerCursor_t *cursor)
+{
+	if (cursor->isNative)
+		return ((EasyFdEntry_t *)cursor->native[cursor->index].data.ptr)->userData;
+	return cursor->events[cursor->index].userData;
+}
+
+/*
+ * 当前事件的返回事件，参考EventType_e
+ */
+static inline int PollerCursorEvent(const PollerCursor_t *cursor)
+{
+	if (!cursor->isNative)
+		return cursor->events[cursor->index].retEvent;
 
+	unsigned int event = cursor->native[cursor->index].events;
+	return ((event & (EPOLLIN | EPOLLPRI | EPOLLRDHUP | EPOLLHUP)) ? EVENT_READ : 0)
+		| ((event & EPOLLOUT) ? EVENT_WRITE : 0)
+		| ((event & EPOLLERR) ? EVENT_ERROR : 0);
+}
 
+#ifdef __cplusplus
+}
+#endif
+
+#endif
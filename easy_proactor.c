@@ -0,0 +1,587 @@
+/*
+ * 完成式(proactor)读写实现
+ * io_uring：每个操作对应一个SQE，提交与收割合并在一次io_uring_enter中
+ * 其他：每个fd维护读、写两个操作队列，在Poller上等待就绪后按顺序执行系统调用
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include "easy_uring.h"
+#include "easy_lock.h"
+#include "easy_proactor.h"
+
+#define PROACTOR_WAIT_EVENTS 64 /* 每次从Poller取出的就绪事件个数 */
+
+/*
+ * 操作节点，按下标链接，节点数组扩容后下标不变
+ */
+typedef struct ProactorNode_t
+{
+	ProactorIo_t io;
+	int next; /* 同队列下一个节点，-1表示结束 */
+}ProactorNode_t;
+
+/*
+ * 非io_uring类型下每个fd的操作队列
+ */
+typedef struct ProactorFd_t
+{
+	int readHead, readTail; /* READ/RECV/ACCEPT */
+	int writeHead, writeTail; /* WRITE/SEND */
+	int event; /* 已注册到Poller的事件 */
+	int nonblock; /* 已设置O_NONBLOCK，从Poller删除后重新检查(fd可能已被关闭并复用) */
+}ProactorFd_t;
+
+/*
+ * ProactorHandle具体结构
+ */
+typedef struct EasyProactor_t
+{
+	int type; /* PT_URING或Poller类型 */
+	EasyIoUring_t ring; /* io_uring队列 */
+	int inflight; /* 已提交未完成的操作个数 */
+	PollerHandle poller; /* 非io_uring类型使用 */
+	ProactorFd_t *fds; /* 按fd索引的操作队列 */
+	int fdCount; /* fds数组大小 */
+	int doneHead, doneTail; /* 已完成待返回的操作 */
+	ProactorNode_t *nodes; /* 节点数组 */
+	int nodeCount; /* nodes数组大小 */
+	int freeHead; /* 空闲节点链表 */
+	EasyLock_t lock; /* POLLER_FLAG_NOLOCK时不启用 */
+}EasyProactor_t;
+
+/*
+ * 分配节点
+ * return：节点下标，失败返回-1
+ */
+static int ProactorNodeAlloc(EasyProactor_t *ep)
+{
+	if (ep->freeHead < 0) /* 扩容 */
+	{
+		int count = ep->nodeCount ? ep->nodeCount * 2 : 64;
+		ProactorNode_t *nodes = (ProactorNode_t *)realloc(ep->nodes, count * sizeof(ProactorNode_t));
+		if (!nodes)
+			return -1;
+
+		int i = ep->nodeCount;
+		for (; i < count; i++)
+			nodes[i].next = (i + 1 < count) ? (i + 1) : -1;
+
+		ep->freeHead = ep->nodeCount;
+		ep->nodes = nodes;
+		ep->nodeCount = count;
+	}
+
+	int idx = ep->freeHead;
+	ep->freeHead = ep->nodes[idx].next;
+	ep->nodes[idx].next = -1;
+	return idx;
+}
+
+/*
+ * 释放节点
+ */
+static void ProactorNodeFree(EasyProactor_t *ep, int idx)
+{
+	ep->nodes[idx].next = ep->freeHead;
+	ep->freeHead = idx;
+}
+
+/*
+ * 节点追加到队列末尾
+ */
+static void ProactorQueuePush(EasyProactor_t *ep, int *head, int *tail, int idx)
+{
+	ep->nodes[idx].next = -1;
+	if (*tail >= 0)
+		ep->nodes[*tail].next = idx;
+	else
+		*head = idx;
+	*tail = idx;
+}
+
+/*
+ * 获取fd的操作队列，不存在时扩容
+ * return：队列，失败返回NULL
+ */
+static ProactorFd_t *ProactorFdAlloc(EasyProactor_t *ep, int fd)
+{
+	if (fd >= ep->fdCount)
+	{
+		int count = ep->fdCount ? ep->fdCount : 64;
+		while (count <= fd)
+			count <<= 1;
+
+		ProactorFd_t *fds = (ProactorFd_t *)realloc(ep->fds, count * sizeof(ProactorFd_t));
+		if (!fds)
+			return NULL;
+
+		int i = ep->fdCount;
+		for (; i < count; i++)
+		{
+			fds[i].readHead = fds[i].readTail = -1;
+			fds[i].writeHead = fds[i].writeTail = -1;
+			fds[i].event = 0;
+			fds[i].nonblock = 0;
+		}
+
+		ep->fds = fds;
+		ep->fdCount = count;
+	}
+
+	return &ep->fds[fd];
+}
+
+/*
+ * 设置fd为非阻塞，就绪后执行的系统调用不能阻塞等待线程
+ * return：0 on success，-1 on fail
+ */
+static int ProactorFdNonblock(EasyProactor_t *ep, int fd)
+{
+	ProactorFd_t *pf = &ep->fds[fd];
+	if (pf->nonblock)
+		return 0;
+
+	int flags = fcntl(fd, F_GETFL);
+	if (flags < 0)
+		return -1;
+	if (!(flags & O_NONBLOCK) && fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+		return -1;
+
+	pf->nonblock = 1;
+	return 0;
+}
+
+/*
+ * 按队列是否为空更新fd在Poller上的事件
+ * return：0 on success，-1 on fail(Poller拒绝该fd，例如epoll下的普通文件)
+ */
+static int ProactorFdArm(EasyProactor_t *ep, int fd)
+{
+	ProactorFd_t *pf = &ep->fds[fd];
+	EasyEvent_t event;
+	int want = 0;
+
+	if (pf->readHead >= 0)
+		want |= EVENT_READ;
+	if (pf->writeHead >= 0)
+		want |= EVENT_WRITE;
+
+	if (want == pf->event)
+		return 0;
+
+	memset(&event, 0, sizeof(event));
+	event.fd = fd;
+	event.event = want;
+
+	if (want == 0)
+	{
+		if (PollerRemoveEvent(ep->poller, &event) < 0)
+			return -1;
+		pf->nonblock = 0;
+	}
+	else if (PollerUpdateEvent(ep->poller, &event) < 0)
+		return -1;
+
+	pf->event = want;
+	return 0;
+}
+
+/*
+ * 执行一次系统调用
+ * return：结果，失败为-errno
+ */
+static int ProactorExecute(ProactorIo_t *io)
+{
+	int ret = -1;
+
+	switch (io->op)
+	{
+	case PROACTOR_OP_READ:
+		ret = (int)read(io->fd, io->buf, io->len);
+		break;
+
+	case PROACTOR_OP_WRITE:
+		ret = (int)write(io->fd, io->buf, io->len);
+		break;
+
+	case PROACTOR_OP_RECV:
+		ret = (int)recv(io->fd, io->buf, io->len, io->flags | MSG_DONTWAIT);
+		break;
+
+	case PROACTOR_OP_SEND:
+		ret = (int)send(io->fd, io->buf, io->len, io->flags | MSG_DONTWAIT);
+		break;
+
+	default:
+		ret = accept4(io->fd, NULL, NULL, io->flags);
+	}
+
+	return (ret < 0) ? -errno : ret;
+}
+
+/*
+ * 按顺序执行队列中的操作，直到队列为空或fd不再就绪
+ */
+static void ProactorRunQueue(EasyProactor_t *ep, int *head, int *tail)
+{
+	int idx = -1, ret = 0;
+
+	while ((idx = *head) >= 0)
+	{
+		ret = ProactorExecute(&ep->nodes[idx].io);
+		if (ret == -EAGAIN || ret == -EWOULDBLOCK || ret == -EINTR) /* 等待下次就绪 */
+			break;
+
+		*head = ep->nodes[idx].next;
+		if (*head < 0)
+			*tail = -1;
+
+		ep->nodes[idx].io.result = ret;
+		ProactorQueuePush(ep, &ep->doneHead, &ep->doneTail, idx);
+	}
+}
+
+/*
+ * 创建Proactor，优先使用io_uring，不支持时退回epoll
+ * size：预计同时进行的操作数量，超出时自动扩容
+ * return：new handle on success，NULL on fail
+ */
+ProactorHandle ProactorCreate(int size)
+{
+	PollerOptions_t options;
+
+	options.size = size;
+	options.flags = 0;
+
+	return ProactorCreateEx(PT_URING, &options);
+}
+
+/*
+ * 按参数创建Proactor
+ * type：PT_URING使用io_uring(不支持时退回PT_EPOLLER)，
+ *   其他类型在对应的Poller上等待就绪后再调用read/write等系统调用
+ * options：创建参数，NULL表示使用默认参数；flags包含POLLER_FLAG_NOLOCK时不加锁
+ * return：new handle on success，NULL on fail
+ */
+ProactorHandle ProactorCreateEx(PollerType_e type, const PollerOptions_t *options)
+{
+	int size = options ? options->size : 0;
+	int flags = options ? options->flags : 0;
+	unsigned int entries = 64;
+
+	EasyProactor_t *ep = (EasyProactor_t *)calloc(1, sizeof(EasyProactor_t));
+	if (!ep)
+		return NULL;
+
+	if (size <= 0)
+		size = 1;
+
+	ep->ring.ringFd = -1;
+	ep->doneHead = ep->doneTail = -1;
+	ep->freeHead = -1;
+
+	if (type == PT_URING)
+	{
+		while (entries < (unsigned int)size && entries < 4096)
+			entries <<= 1;
+
+		if (IoUringInit(&ep->ring, entries, 0) == 0)
+			ep->type = PT_URING;
+		else
+			type = PT_EPOLLER; /* 不支持io_uring */
+	}
+
+	if (type != PT_URING)
+	{
+		ep->type = type;
+		ep->poller = PollerCreateEx(type, options);
+		if (!ep->poller)
+		{
+			free(ep);
+			return NULL;
+		}
+	}
+
+	EasyLockInit(&ep->lock, !(flags & POLLER_FLAG_NOLOCK));
+
+	return ep;
+}
+
+/*
+ * 销毁Proactor，未完成的操作直接丢弃
+ * handle：ProactorCreate()返回的句柄
+ */
+void ProactorDestroy(ProactorHandle handle)
+{
+	EasyProactor_t *ep = (EasyProactor_t *)handle;
+	if (!ep)
+		return;
+
+	if (ep->type == PT_URING)
+		IoUringDestroy(&ep->ring); /* 关闭io_uring时内核取消全部操作 */
+	else
+		PollerDestroy(ep->poller);
+	ep->poller = NULL;
+
+	if (ep->fds)
+		free(ep->fds);
+	ep->fds = NULL;
+
+	if (ep->nodes)
+		free(ep->nodes);
+	ep->nodes = NULL;
+
+	EasyLockDestroy(&ep->lock);
+
+	free(ep);
+}
+
+/*
+ * 获取实际使用的类型
+ * return：PT_URING或退回的Poller类型，失败返回-1
+ */
+int ProactorGetType(ProactorHandle handle)
+{
+	EasyProactor_t *ep = (EasyProactor_t *)handle;
+	if (!ep)
+		return -1;
+
+	return ep->type;
+}
+
+/*
+ * 填写io_uring的SQE，调用者已加锁
+ * return：0 on success，-1 on fail
+ */
+static int ProactorSubmitUring(EasyProactor_t *ep, int idx)
+{
+	struct io_uring_sqe *sqe = IoUringGetSqe(&ep->ring);
+	if (!sqe)
+		return -1;
+
+	ProactorIo_t *io = &ep->nodes[idx].io;
+
+	sqe->fd = io->fd;
+	sqe->user_data = (unsigned long long)idx;
+
+	switch (io->op)
+	{
+	case PROACTOR_OP_READ:
+	case PROACTOR_OP_WRITE:
+		sqe->opcode = (io->op == PROACTOR_OP_READ) ? IORING_OP_READ : IORING_OP_WRITE;
+		sqe->addr = (unsigned long long)(unsigned long)io->buf;
+		sqe->len = io->len;
+		sqe->off = (unsigned long long)-1; /* 使用文件当前位置 */
+		break;
+
+	case PROACTOR_OP_RECV:
+	case PROACTOR_OP_SEND:
+		sqe->opcode = (io->op == PROACTOR_OP_RECV) ? IORING_OP_RECV : IORING_OP_SEND;
+		sqe->addr = (unsigned long long)(unsigned long)io->buf;
+		sqe->len = io->len;
+		sqe->msg_flags = io->flags;
+		break;
+
+	default:
+		sqe->opcode = IORING_OP_ACCEPT;
+		sqe->accept_flags = io->flags;
+	}
+
+	ep->inflight++;
+	return 0;
+}
+
+/*
+ * 提交操作，下次ProactorWaitEvent()时与等待一起进入内核
+ * handle：Proactor句柄
+ * io：操作，result字段不使用
+ * return：0 on success，-1 on fail
+ */
+int ProactorSubmit(ProactorHandle handle, const ProactorIo_t *io)
+{
+	EasyProactor_t *ep = (EasyProactor_t *)handle;
+	if (!ep || !io || (io->fd < 0) || (io->len < 0)
+		|| (io->op < PROACTOR_OP_READ) || (io->op > PROACTOR_OP_ACCEPT))
+		return -1;
+
+	ProactorFd_t *pf = NULL;
+	int ret = -1, tail = -1, *head = NULL, *last = NULL;
+
+	EasyLock(&ep->lock);
+
+	int idx = ProactorNodeAlloc(ep);
+	if (idx < 0)
+	{
+		EasyUnlock(&ep->lock);
+		return -1;
+	}
+
+	memcpy(&ep->nodes[idx].io, io, sizeof(ProactorIo_t));
+	ep->nodes[idx].io.result = 0;
+
+	if (ep->type == PT_URING)
+		ret = ProactorSubmitUring(ep, idx);
+	else if ((pf = ProactorFdAlloc(ep, io->fd)) != NULL && ProactorFdNonblock(ep, io->fd) == 0)
+	{
+		head = (io->op == PROACTOR_OP_WRITE || io->op == PROACTOR_OP_SEND) ? &pf->writeHead : &pf->readHead;
+		last = (io->op == PROACTOR_OP_WRITE || io->op == PROACTOR_OP_SEND) ? &pf->writeTail : &pf->readTail;
+		tail = *last;
+		ProactorQueuePush(ep, head, last, idx);
+
+		ret = ProactorFdArm(ep, io->fd);
+		if (ret < 0) /* 注册失败，从队列中摘除 */
+		{
+			*last = tail;
+			if (tail >= 0)
+				ep->nodes[tail].next = -1;
+			else
+				*head = -1;
+		}
+	}
+
+	if (ret < 0)
+		ProactorNodeFree(ep, idx);
+
+	EasyUnlock(&ep->lock);
+	return ret;
+}
+
+/*
+ * 从完成队列取出操作，调用者已加锁
+ * return：取出的个数
+ */
+static int ProactorTakeDone(EasyProactor_t *ep, ProactorIo_t *completions, int maxevents)
+{
+	int nums = 0, idx = -1;
+
+	while ((nums < maxevents) && (idx = ep->doneHead) >= 0)
+	{
+		ep->doneHead = ep->nodes[idx].next;
+		if (ep->doneHead < 0)
+			ep->doneTail = -1;
+
+		memcpy(&completions[nums++], &ep->nodes[idx].io, sizeof(ProactorIo_t));
+		ProactorNodeFree(ep, idx);
+	}
+
+	return nums;
+}
+
+/*
+ * io_uring等待完成
+ */
+static int ProactorWaitUring(EasyProactor_t *ep, ProactorIo_t *completions, int maxevents, int timeout)
+{
+	struct io_uring_cqe *cqe = NULL;
+	int nums = 0, idx = -1;
+
+	EasyLock(&ep->lock);
+	int inflight = ep->inflight;
+	int ready = (IoUringPeekCqe(&ep->ring) != NULL);
+	unsigned int submit = IoUringFlush(&ep->ring);
+	EasyUnlock(&ep->lock);
+
+	if (inflight == 0) /* 没有操作 */
+		return 0;
+
+	if (IoUringWait(&ep->ring, submit, ready ? 0 : 1, timeout) < 0) /* 出错 */
+		return -1;
+
+	EasyLock(&ep->lock);
+
+	while (nums < maxevents)
+	{
+		cqe = IoUringPeekCqe(&ep->ring);
+		if (!cqe)
+		{
+			/* CQ已取空，取回内核中溢出的完成事件 */
+			if (!IoUringOverflow(&ep->ring) || IoUringReap(&ep->ring) < 0)
+				break;
+			continue;
+		}
+
+		idx = (int)cqe->user_data;
+		ep->nodes[idx].io.result = cqe->res;
+		IoUringCqeSeen(&ep->ring);
+
+		memcpy(&completions[nums++], &ep->nodes[idx].io, sizeof(ProactorIo_t));
+		ProactorNodeFree(ep, idx);
+		ep->inflight--;
+	}
+
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
+
+/*
+ * 等待就绪后执行操作
+ */
+static int ProactorWaitPoller(EasyProactor_t *ep, ProactorIo_t *completions, int maxevents, int timeout)
+{
+	EasyEvent_t events[PROACTOR_WAIT_EVENTS];
+	ProactorFd_t *pf = NULL;
+	int nums = 0, i = 0, fd = -1;
+
+	EasyLock(&ep->lock);
+	nums = ProactorTakeDone(ep, completions, maxevents);
+	EasyUnlock(&ep->lock);
+
+	if (nums > 0) /* 已有完成的操作 */
+		return nums;
+
+	nums = PollerWaitEvent(ep->poller, events, PROACTOR_WAIT_EVENTS, timeout);
+	if (nums < 0) /* 出错 */
+		return -1;
+
+	EasyLock(&ep->lock);
+
+	for (i = 0; i < nums; i++)
+	{
+		fd = events[i].fd;
+		pf = &ep->fds[fd];
+
+		/* 出错时两个方向都执行，由系统调用返回错误 */
+		if (events[i].retEvent & (EVENT_READ | EVENT_ERROR))
+			ProactorRunQueue(ep, &pf->readHead, &pf->readTail);
+		if (events[i].retEvent & (EVENT_WRITE | EVENT_ERROR))
+			ProactorRunQueue(ep, &pf->writeHead, &pf->writeTail);
+
+		ProactorFdArm(ep, fd);
+	}
+
+	nums = ProactorTakeDone(ep, completions, maxevents);
+
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
+
+/*
+ * 等待操作完成
+ * handle：Proactor句柄
+ * completions：保存完成的操作，result为结果
+ * maxevents：completions数组大小
+ * timeout：超时时间(ms)
+ * return：返回完成的操作个数，失败返回-1
+ */
+int ProactorWaitEvent(ProactorHandle handle, ProactorIo_t *completions, int maxevents, int timeout)
+{
+	EasyProactor_t *ep = (EasyProactor_t *)handle;
+	if (!ep || !completions || (maxevents < 1))
+		return -1;
+
+	if (ep->type == PT_URING)
+		return ProactorWaitUring(ep, completions, maxevents, timeout);
+
+	return ProactorWaitPoller(ep, completions, maxevents, timeout);
+}
+
@@ -0,0 +1,100 @@
+/*
+ * 完成式(proactor)读写声明
+ * 提交读/写/accept/recv/send操作，由ProactorWaitEvent()返回完成结果
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_PROACTOR_H__
+#define __FREE_EASY_PROACTOR_H__
+#include "easy_poller.h"
+
+typedef void *ProactorHandle;
+
+/*
+ * 操作类型
+ */
+typedef enum ProactorOp_e
+{
+	PROACTOR_OP_READ, /* read(fd, buf, len) */
+	PROACTOR_OP_WRITE, /* write(fd, buf, len) */
+	PROACTOR_OP_RECV, /* recv(fd, buf, len, flags) */
+	PROACTOR_OP_SEND, /* send(fd, buf, len, flags) */
+	PROACTOR_OP_ACCEPT /* accept4(fd, NULL, NULL, flags)，不使用buf/len */
+}ProactorOp_e;
+
+/*
+ * 一次读写操作
+ * buf由调用者提供，操作完成前必须保持有效
+ */
+typedef struct ProactorIo_t
+{
+	int fd; /* 文件fd */
+	int op; /* 操作类型，ProactorOp_e */
+	void *buf; /* 数据缓冲区 */
+	int len; /* 缓冲区长度 */
+	int flags; /* recv/send的flags，accept的SOCK_NONBLOCK/SOCK_CLOEXEC */
+	int result; /* 完成结果：读写的字节数或accept得到的fd，失败为-errno */
+	void *userData; /* 用户数据，完成时原样返回 */
+}ProactorIo_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 创建Proactor，优先使用io_uring，不支持时退回epoll
+ * size：预计同时进行的操作数量，超出时自动扩容
+ * return：new handle on success，NULL on fail
+ */
+ProactorHandle ProactorCreate(int size);
+
+/*
+ * 按参数创建Proactor
+ * type：PT_URING使用io_uring(不支持时退回PT_EPOLLER)，
+ *   其他类型在对应的Poller上等待就绪后再调用read/write等系统调用
+ * options：创建参数，NULL表示使用默认参数；flags包含POLLER_FLAG_NOLOCK时不加锁
+ * return：new handle on success，NULL on fail
+ */
+ProactorHandle ProactorCreateEx(PollerType_e type, const PollerOptions_t *options);
+
+/*
+ * 销毁Proactor，未完成的操作直接丢弃
+ * handle：ProactorCreate()返回的句柄
+ */
+void ProactorDestroy(ProactorHandle handle);
+
+/*
+ * 获取实际使用的类型
+ * return：PT_URING或退回的Poller类型，失败返回-1
+ */
+int ProactorGetType(ProactorHandle handle);
+
+/*
+ * 提交操作，下次ProactorWaitEvent()时与等待一起进入内核
+ * 同一fd上同方向(读/写)的操作在非io_uring类型下按提交顺序执行；io_uring下不保证顺序
+ * 非io_uring类型下提交时把fd设为O_NONBLOCK，就绪后的系统调用不会阻塞等待线程；
+ *   Poller不接受的fd(例如epoll下的普通文件)提交失败
+ * handle：Proactor句柄
+ * io：操作，result字段不使用
+ * return：0 on success，-1 on fail
+ */
+int ProactorSubmit(ProactorHandle handle, const ProactorIo_t *io);
+
+/*
+ * 等待操作完成
+ * handle：Proactor句柄
+ * completions：保存完成的操作，result为结果
+ * maxevents：completions数组大小
+ * timeout：超时时间(ms)
+ * return：返回完成的操作个数，失败返回-1
+ */
+int ProactorWaitEvent(ProactorHandle handle, ProactorIo_t *completions, int maxevents, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,324 @@
+/*
+ * 多线程reactor池实现
+ * 线程之间不共享Poller，跨线程注册通过事件循环的无锁任务队列完成
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include "easy_reactor.h"
+
+/*
+ * 一个reactor线程
+ */
+typedef struct Reactor_t
+{
+	EventLoopHandle loop;
+	pthread_t thread;
+	int started; /* 线程已启动 */
+	int stopped; /* 线程已退出，剩余的注册任务不再注册 */
+	int load; /* 已分配的fd个数，原子操作 */
+	int pending; /* 尚未执行的注册任务数，原子操作 */
+}__attribute__((aligned(64))) Reactor_t; /* 各线程的计数不共享缓存行 */
+
+/*
+ * ReactorPoolHandle具体结构
+ */
+typedef struct EasyReactorPool_t
+{
+	Reactor_t *reactors;
+	int count; /* 线程数 */
+	int policy; /* 分配策略 */
+	unsigned int next; /* 轮流分配的计数，原子操作 */
+}EasyReactorPool_t;
+
+/*
+ * 跨线程注册任务
+ */
+typedef struct ReactorAdd_t
+{
+	Reactor_t *reactor;
+	int fd;
+	int events;
+	EventLoopHandler handler;
+	void *ctx;
+}ReactorAdd_t;
+
+/*
+ * 线程函数
+ */
+static void *ReactorThread(void *arg)
+{
+	Reactor_t *reactor = (Reactor_t *)arg;
+
+	EventLoopRun(reactor->loop);
+	return NULL;
+}
+
+/*
+ * 在目标线程中注册fd
+ */
+static void ReactorAddTask(void *arg)
+{
+	ReactorAdd_t *add = (ReactorAdd_t *)arg;
+	Reactor_t *reactor = add->reactor;
+
+	__atomic_fetch_sub(&reactor->pending, 1, __ATOMIC_RELAXED);
+	if (reactor->stopped || EventLoopAdd(reactor->loop, add->fd, add->events, add->handler, add->ctx) != 0)
+	{
+		__atomic_fetch_sub(&reactor->load, 1, __ATOMIC_RELAXED);
+		add->handler(reactor->loop, add->fd, EVENT_ERROR, add->ctx);
+	}
+
+	free(add);
+}
+
+/*
+ * 线程退出后执行剩余的注册任务，每个都以EVENT_ERROR通知调用者并释放参数
+ * 只取任务，不分发fd事件
+ */
+static void ReactorDrain(Reactor_t *reactor)
+{
+	PollerHandle poller = EventLoopGetPoller(reactor->loop);
+	EasyEvent_t events[16];
+
+	reactor->stopped = 1;
+	while (__atomic_load_n(&reactor->pending, __ATOMIC_RELAXED) > 0)
+	{
+		if (PollerWaitEvent(poller, events, 16, 0) < 0)
+			break;
+	}
+}
+
+/*
+ * 按策略选择线程
+ * return：线程下标
+ */
+static int ReactorPick(EasyReactorPool_t *pool)
+{
+	if (pool->policy == REACTOR_LEAST_LOADED)
+	{
+		int i = 1, best = 0;
+		int min = __atomic_load_n(&pool->reactors[0].load, __ATOMIC_RELAXED), load = 0;
+
+		for (; i < pool->count; i++)
+		{
+			load = __atomic_load_n(&pool->reactors[i].load, __ATOMIC_RELAXED);
+			if (load < min)
+			{
+				min = load;
+				best = i;
+			}
+		}
+		return best;
+	}
+
+	return (int)(__atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED) % (unsigned int)pool->count);
+}
+
+/*
+ * 创建reactor池并启动线程
+ * options：创建参数，NULL表示每个CPU一个epoll线程、轮流分配、不绑定CPU
+ * return：new handle on success，NULL on fail
+ */
+ReactorPoolHandle ReactorPoolCreate(const ReactorPoolOptions_t *options)
+{
+	int threads = options ? options->threads : 0;
+	PollerType_e type = options ? options->type : PT_EPOLLER;
+	int size = options ? options->size : 0;
+	int i = 0;
+
+	if (threads <= 0)
+		threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads <= 0)
+		threads = 1;
+
+	EasyReactorPool_t *pool = (EasyReactorPool_t *)calloc(1, sizeof(EasyReactorPool_t));
+	if (!pool)
+		return NULL;
+
+	pool->policy = options ? options->policy : REACTOR_ROUND_ROBIN;
+	/* calloc只保证16字节对齐，按缓存行对齐分配 */
+	if (posix_memalign((void **)&pool->reactors, 64, threads * sizeof(Reactor_t)) != 0)
+	{
+		free(pool);
+		return NULL;
+	}
+	memset(pool->reactors, 0, threads * sizeof(Reactor_t));
+	pool->count = threads;
+
+	for (i = 0; i < threads; i++)
+	{
+		Reactor_t *reactor = &pool->reactors[i];
+
+		reactor->loop = EventLoopCreate(type, size);
+		if (!reactor->loop)
+			goto fail;
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+
+		if (options && options->cpus && options->cpuCount > 0) /* 绑定CPU */
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(options->cpus[i % options->cpuCount], &set);
+			pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+		}
+
+		int ret = pthread_create(&reactor->thread, &attr, ReactorThread, reactor);
+		pthread_attr_destroy(&attr);
+		if (ret != 0)
+			goto fail;
+
+		reactor->started = 1;
+	}
+
+	return pool;
+
+fail:
+	ReactorPoolDestroy(pool);
+	return NULL;
+}
+
+/*
+ * 停止全部线程并销毁，已注册的fd不关闭
+ * handle：ReactorPoolCreate()返回的句柄
+ */
+void ReactorPoolDestroy(ReactorPoolHandle handle)
+{
+	EasyReactorPool_t *pool = (EasyReactorPool_t *)handle;
+	int i = 0;
+	if (!pool)
+		return;
+
+	for (i = 0; i < pool->count; i++)
+	{
+		Reactor_t *reactor = &pool->reactors[i];
+		if (reactor->started)
+		{
+			EventLoopStop(reactor->loop);
+			pthread_join(reactor->thread, NULL);
+		}
+
+		if (reactor->loop)
+		{
+			ReactorDrain(reactor);
+			EventLoopDestroy(reactor->loop);
+		}
+		reactor->loop = NULL;
+	}
+
+	free(pool->reactors);
+	free(pool);
+}
+
+/*
+ * 获取线程数
+ * return：线程数，失败返回-1
+ */
+int ReactorPoolGetCount(ReactorPoolHandle handle)
+{
+	EasyReactorPool_t *pool = (EasyReactorPool_t *)handle;
+	if (!pool)
+		return -1;
+
+	return pool->count;
+}
+
+/*
+ * 获取第index个线程的事件循环
+ * return：事件循环句柄，失败返回NULL
+ */
+EventLoopHandle ReactorPoolGetLoop(ReactorPoolHandle handle, int index)
+{
+	EasyReactorPool_t *pool = (EasyReactorPool_t *)handle;
+	if (!pool || index < 0 || index >= pool->count)
+		return NULL;
+
+	return pool->reactors[index].loop;
+}
+
+/*
+ * 获取第index个线程当前的fd个数
+ * return：fd个数，失败返回-1
+ */
+int ReactorPoolGetLoad(ReactorPoolHandle handle, int index)
+{
+	EasyReactorPool_t *pool = (EasyReactorPool_t *)handle;
+	if (!pool || index < 0 || index >= pool->count)
+		return -1;
+
+	return __atomic_load_n(&pool->reactors[index].load, __ATOMIC_RELAXED);
+}
+
+/*
+ * 按策略选择一个线程注册fd，任意线程可调用
+ * handle：reactor池句柄
+ * fd/events/handler/ctx：同EventLoopAdd()
+ * return：选中的线程下标，失败返回-1
+ */
+int ReactorPoolAdd(ReactorPoolHandle handle, int fd, int events, EventLoopHandler handler, void *ctx)
+{
+	EasyReactorPool_t *pool = (EasyReactorPool_t *)handle;
+	if (!pool || fd < 0 || !handler)
+		return -1;
+
+	int index = ReactorPick(pool);
+	Reactor_t *reactor = &pool->reactors[index];
+
+	ReactorAdd_t *add = (ReactorAdd_t *)malloc(sizeof(ReactorAdd_t));
+	if (!add)
+		return -1;
+
+	add->reactor = reactor;
+	add->fd = fd;
+	add->events = events;
+	add->handler = handler;
+	add->ctx = ctx;
+
+	/* 先计数，least-loaded下紧接着的分配能看到 */
+	__atomic_fetch_add(&reactor->load, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&reactor->pending, 1, __ATOMIC_RELAXED);
+	if (EventLoopPostTask(reactor->loop, ReactorAddTask, add) != 0)
+	{
+		__atomic_fetch_sub(&reactor->pending, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_sub(&reactor->load, 1, __ATOMIC_RELAXED);
+		free(add);
+		return -1;
+	}
+
+	return index;
+}
+
+/*
+ * 删除fd，只能在fd所在的线程中调用
+ * return：0 on success，-1 on fail
+ */
+int ReactorPoolRemove(ReactorPoolHandle handle, EventLoopHandle loop, int fd)
+{
+	EasyReactorPool_t *pool = (EasyReactorPool_t *)handle;
+	int i = 0;
+	if (!pool)
+		return -1;
+
+	for (; i < pool->count; i++)
+	{
+		if (pool->reactors[i].loop != loop)
+			continue;
+
+		if (EventLoopRemove(loop, fd) != 0)
+			return -1;
+
+		__atomic_fetch_sub(&pool->reactors[i].load, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	return -1;
+}
+
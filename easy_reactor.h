@@ -0,0 +1,95 @@
+/*
+ * 多线程reactor池声明
+ * 每个线程运行一个独立的事件循环(Poller不加锁)，新fd按策略分配到其中一个线程
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_REACTOR_H__
+#define __FREE_EASY_REACTOR_H__
+#include "easy_loop.h"
+
+typedef void *ReactorPoolHandle;
+
+/*
+ * fd分配策略
+ */
+typedef enum ReactorPolicy_e
+{
+	REACTOR_ROUND_ROBIN, /* 轮流分配 */
+	REACTOR_LEAST_LOADED /* 分配到当前fd最少的线程 */
+}ReactorPolicy_e;
+
+/*
+ * 创建参数
+ */
+typedef struct ReactorPoolOptions_t
+{
+	int threads; /* 线程数，<=0时使用在线CPU个数 */
+	PollerType_e type; /* 各线程使用的Poller类型 */
+	int size; /* 每个事件循环每次等待最多返回的事件个数，<=0时使用默认值 */
+	int policy; /* 分配策略，ReactorPolicy_e */
+	const int *cpus; /* 绑定的CPU，线程i绑定cpus[i % cpuCount]；NULL表示不绑定 */
+	int cpuCount; /* cpus数组大小 */
+}ReactorPoolOptions_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 创建reactor池并启动线程
+ * options：创建参数，NULL表示每个CPU一个epoll线程、轮流分配、不绑定CPU
+ * return：new handle on success，NULL on fail
+ */
+ReactorPoolHandle ReactorPoolCreate(const ReactorPoolOptions_t *options);
+
+/*
+ * 停止全部线程并销毁，已注册的fd不关闭
+ * 尚未执行的注册在本线程中以EVENT_ERROR调用handler，由调用者关闭fd
+ * handle：ReactorPoolCreate()返回的句柄
+ */
+void ReactorPoolDestroy(ReactorPoolHandle handle);
+
+/*
+ * 获取线程数
+ * return：线程数，失败返回-1
+ */
+int ReactorPoolGetCount(ReactorPoolHandle handle);
+
+/*
+ * 获取第index个线程的事件循环，可用于EventLoopPostTask()
+ * return：事件循环句柄，失败返回NULL
+ */
+EventLoopHandle ReactorPoolGetLoop(ReactorPoolHandle handle, int index);
+
+/*
+ * 获取第index个线程当前的fd个数
+ * return：fd个数，失败返回-1
+ */
+int ReactorPoolGetLoad(ReactorPoolHandle handle, int index);
+
+/*
+ * 按策略选择一个线程注册fd，任意线程可调用
+ * 注册以任务的方式在目标线程中执行，之后的事件都在该线程中回调；
+ * 注册失败时在目标线程中以EVENT_ERROR调用一次handler，注册前池被销毁时在ReactorPoolDestroy()的线程中调用
+ * handle：reactor池句柄
+ * fd/events/handler/ctx：同EventLoopAdd()
+ * return：选中的线程下标，失败返回-1
+ */
+int ReactorPoolAdd(ReactorPoolHandle handle, int fd, int events, EventLoopHandler handler, void *ctx);
+
+/*
+ * 删除fd，只能在fd所在的线程中调用(通常在回调中，loop为回调的参数)
+ * 与EventLoopRemove()相同，同时更新该线程的fd个数
+ * return：0 on success，-1 on fail
+ */
+int ReactorPoolRemove(ReactorPoolHandle handle, EventLoopHandle loop, int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
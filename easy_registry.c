@@ -0,0 +1,247 @@
+/*
+ * fd注册表实现
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "easy_registry.h"
+
+#define REGISTRY_PAGE_SHIFT 10
+#define REGISTRY_PAGE_SIZE (1 << REGISTRY_PAGE_SHIFT) /* 每页fd个数 */
+#define REGISTRY_PAGE_MASK (REGISTRY_PAGE_SIZE - 1)
+
+/*
+ * 获取fd对应的索引项，页不存在时分配
+ * return：索引项，失败返回NULL
+ */
+static EasyFdEntry_t *RegistryEntryAlloc(EasyRegistry_t *reg, int fd)
+{
+	int page = fd >> REGISTRY_PAGE_SHIFT;
+
+	if (page >= reg->pageCount) /* 扩展页表 */
+	{
+		int count = reg->pageCount ? reg->pageCount : 1;
+		while (count <= page)
+			count <<= 1;
+
+		EasyFdEntry_t **pages = (EasyFdEntry_t **)realloc(reg->pages, count * sizeof(EasyFdEntry_t *));
+		if (!pages)
+			return NULL;
+
+		memset(&pages[reg->pageCount], 0, (count - reg->pageCount) * sizeof(EasyFdEntry_t *));
+		reg->pages = pages;
+		reg->pageCount = count;
+	}
+
+	EasyFdEntry_t *entries = reg->pages[page];
+	if (!entries) /* 分配页 */
+	{
+		entries = (EasyFdEntry_t *)malloc(REGISTRY_PAGE_SIZE * sizeof(EasyFdEntry_t));
+		if (!entries)
+			return NULL;
+
+		int i = 0, base = page << REGISTRY_PAGE_SHIFT;
+		for (; i < REGISTRY_PAGE_SIZE; i++)
+		{
+			entries[i].fd = base + i;
+			entries[i].slot = -1;
+			entries[i].userData = NULL;
+			entries[i].applied = 0;
+			entries[i].state = 0;
+			entries[i].gen = 0;
+		}
+		reg->pages[page] = entries;
+	}
+
+	return &entries[fd & REGISTRY_PAGE_MASK];
+}
+
+/*
+ * 追加一个事件块
+ * return：0 on success，-1 on fail
+ */
+static int RegistryGrow(EasyRegistry_t *reg)
+{
+	if (reg->chunkCount >= reg->chunkSlots) /* 扩展块数组，只拷贝块指针 */
+	{
+		int slots = reg->chunkSlots ? reg->chunkSlots * 2 : 4;
+		EasyEvent_t **chunks = (EasyEvent_t **)realloc(reg->chunks, slots * sizeof(EasyEvent_t *));
+		if (!chunks)
+			return -1;
+
+		reg->chunks = chunks;
+		reg->chunkSlots = slots;
+	}
+
+	EasyEvent_t *chunk = (EasyEvent_t *)calloc(REGISTRY_CHUNK_SIZE, sizeof(EasyEvent_t));
+	if (!chunk)
+		return -1;
+
+	reg->chunks[reg->chunkCount++] = chunk;
+	reg->eventCapacity += REGISTRY_CHUNK_SIZE;
+	return 0;
+}
+
+/*
+ * 释放末尾的空闲事件块
+ * 至少空出两个整块才释放一块，避免在块边界上反复分配释放
+ */
+static void RegistryShrink(EasyRegistry_t *reg)
+{
+	while (reg->chunkCount > reg->minChunks
+		&& reg->eventSize <= (reg->chunkCount - 2) * REGISTRY_CHUNK_SIZE)
+	{
+		free(reg->chunks[--reg->chunkCount]);
+		reg->chunks[reg->chunkCount] = NULL;
+		reg->eventCapacity -= REGISTRY_CHUNK_SIZE;
+	}
+}
+
+/*
+ * 初始化注册表
+ * size：初始容量，不够时自动扩容
+ * return：0 on success，-1 on fail
+ */
+int RegistryInit(EasyRegistry_t *reg, int size)
+{
+	if (!reg)
+		return -1;
+
+	if (size <= 0)
+		size = 1;
+
+	memset(reg, 0, sizeof(EasyRegistry_t));
+	reg->minChunks = (size + REGISTRY_CHUNK_SIZE - 1) >> REGISTRY_CHUNK_SHIFT;
+
+	while (reg->chunkCount < reg->minChunks)
+	{
+		if (RegistryGrow(reg) < 0)
+		{
+			RegistryDestroy(reg);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * 释放注册表
+ */
+void RegistryDestroy(EasyRegistry_t *reg)
+{
+	if (!reg)
+		return;
+
+	int i = 0;
+	for (; i < reg->pageCount; i++)
+	{
+		if (reg->pages[i])
+			free(reg->pages[i]);
+	}
+
+	if (reg->pages)
+		free(reg->pages);
+	reg->pages = NULL;
+	reg->pageCount = 0;
+
+	for (i = 0; i < reg->chunkCount; i++)
+		free(reg->chunks[i]);
+
+	if (reg->chunks)
+		free(reg->chunks);
+	reg->chunks = NULL;
+	reg->chunkCount = 0;
+	reg->chunkSlots = 0;
+	reg->eventCapacity = 0;
+	reg->eventSize = 0;
+}
+
+/*
+ * 获取fd的索引项
+ * return：索引项，fd从未注册过返回NULL
+ */
+EasyFdEntry_t *RegistryEntry(const EasyRegistry_t *reg, int fd)
+{
+	if (fd < 0)
+		return NULL;
+
+	int page = fd >> REGISTRY_PAGE_SHIFT;
+	if (page >= reg->pageCount || !reg->pages[page])
+		return NULL;
+
+	return &reg->pages[page][fd & REGISTRY_PAGE_MASK];
+}
+
+/*
+ * 查找fd
+ * return：fd对应的下标，未注册返回-1
+ */
+int RegistryFind(const EasyRegistry_t *reg, int fd)
+{
+	EasyFdEntry_t *entry = RegistryEntry(reg, fd);
+	return entry ? entry->slot : -1;
+}
+
+/*
+ * 添加fd，调用前需确认fd未注册
+ * event：待添加事件
+ * return：新元素的下标，失败(内存不足)返回-1
+ */
+int RegistryInsert(EasyRegistry_t *reg, const EasyEvent_t *event)
+{
+	if (reg->eventSize >= reg->eventCapacity && RegistryGrow(reg) < 0) /* 已经满了，扩容 */
+		return -1;
+
+	EasyFdEntry_t *entry = RegistryEntryAlloc(reg, event->fd);
+	if (!entry)
+		return -1;
+
+	int idx = reg->eventSize++;
+	memcpy(RegistryAt(reg, idx), event, sizeof(EasyEvent_t));
+	entry->slot = idx;
+	entry->userData = event->userData;
+
+	return idx;
+}
+
+/*
+ * 更新已注册的事件
+ * idx：RegistryFind()返回的下标
+ * event：新的事件
+ */
+void RegistryUpdate(EasyRegistry_t *reg, int idx, const EasyEvent_t *event)
+{
+	memcpy(RegistryAt(reg, idx), event, sizeof(EasyEvent_t));
+	RegistryEntry(reg, event->fd)->userData = event->userData;
+}
+
+/*
+ * 删除fd
+ * 末尾元素会被移动到被删除的位置，使用平行数组的调用者需要做同样的移动
+ * return：被删除元素原来的下标，未注册返回-1
+ */
+int RegistryRemove(EasyRegistry_t *reg, int fd)
+{
+	EasyFdEntry_t *entry = RegistryEntry(reg, fd);
+	if (!entry || entry->slot < 0)
+		return -1;
+
+	int idx = entry->slot;
+	int last = --reg->eventSize;
+
+	if (idx != last) /* 末尾元素填补空位 */
+	{
+		EasyEvent_t *moved = RegistryAt(reg, idx);
+		memcpy(moved, RegistryAt(reg, last), sizeof(EasyEvent_t));
+		RegistryEntry(reg, moved->fd)->slot = idx;
+	}
+
+	entry->slot = -1;
+	entry->userData = NULL;
+	RegistryShrink(reg);
+	return idx;
+}
+
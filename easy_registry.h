@@ -0,0 +1,113 @@
+/*
+ * fd注册表声明
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_REGISTRY_H__
+#define __FREE_EASY_REGISTRY_H__
+#include "easy_event.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * fd索引项
+ * 按fd分页存放，页一旦分配就不再移动，直到注册表销毁
+ * 因此可以把索引项地址交给内核(如epoll_event.data.ptr)，事件返回时直接取得fd和用户数据
+ */
+typedef struct EasyFdEntry_t
+{
+	int fd; /* 对应的fd */
+	int slot; /* 在事件数组中的下标，-1表示未注册 */
+	void *userData; /* 注册时的用户数据 */
+	unsigned int applied; /* 后端已提交给内核的事件 */
+	int state; /* 后端私有的状态标志，fd删除后保留 */
+	unsigned int gen; /* 后端私有的序号，用于识别已失效的内核通知 */
+}EasyFdEntry_t;
+
+#define REGISTRY_CHUNK_SHIFT 8
+#define REGISTRY_CHUNK_SIZE (1 << REGISTRY_CHUNK_SHIFT) /* 每块事件个数 */
+#define REGISTRY_CHUNK_MASK (REGISTRY_CHUNK_SIZE - 1)
+
+/*
+ * fd注册表：稀疏的fd->slot索引 + 密集的事件数组
+ * 查找/添加/删除均为O(1)，RegistryAt(0 ~ eventSize-1)可直接遍历
+ * 事件数组分块存放：扩容只追加新块，已有元素不移动也不拷贝；
+ * 使用量持续低于容量时释放末尾的空闲块，但不低于初始容量
+ * 注册表本身不加锁，由调用者保证互斥
+ * 注册表不使用事件的retEvent字段，后端可以用来保存每个fd的私有状态
+ */
+typedef struct EasyRegistry_t
+{
+	EasyFdEntry_t **pages; /* fd索引页 */
+	int pageCount; /* pages数组大小 */
+	EasyEvent_t **chunks; /* 事件块 */
+	int chunkCount; /* 已分配的事件块个数 */
+	int chunkSlots; /* chunks数组大小 */
+	int minChunks; /* 收缩时至少保留的事件块个数 */
+	int eventCapacity; /* 当前容量 */
+	int eventSize; /* 当前元素个数 */
+}EasyRegistry_t;
+
+/*
+ * 获取下标为idx的事件，idx必须小于eventSize
+ */
+static inline EasyEvent_t *RegistryAt(const EasyRegistry_t *reg, int idx)
+{
+	return &reg->chunks[idx >> REGISTRY_CHUNK_SHIFT][idx & REGISTRY_CHUNK_MASK];
+}
+
+/*
+ * 初始化注册表
+ * size：初始容量，不够时自动扩容
+ * return：0 on success，-1 on fail
+ */
+int RegistryInit(EasyRegistry_t *reg, int size);
+
+/*
+ * 释放注册表
+ */
+void RegistryDestroy(EasyRegistry_t *reg);
+
+/*
+ * 查找fd
+ * return：fd对应的下标，未注册返回-1
+ */
+int RegistryFind(const EasyRegistry_t *reg, int fd);
+
+/*
+ * 获取fd的索引项
+ * return：索引项，fd从未注册过返回NULL
+ */
+EasyFdEntry_t *RegistryEntry(const EasyRegistry_t *reg, int fd);
+
+/*
+ * 添加fd，调用前需确认fd未注册
+ * event：待添加事件
+ * return：新元素的下标，失败(内存不足)返回-1
+ */
+int RegistryInsert(EasyRegistry_t *reg, const EasyEvent_t *event);
+
+/*
+ * 更新已注册的事件
+ * idx：RegistryFind()返回的下标
+ * event：新的事件
+ */
+void RegistryUpdate(EasyRegistry_t *reg, int idx, const EasyEvent_t *event);
+
+/*
+ * 删除fd
+ * 末尾元素会被移动到被删除的位置，使用平行数组的调用者需要做同样的移动
+ * return：被删除元素原来的下标，未注册返回-1
+ */
+int RegistryRemove(EasyRegistry_t *reg, int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,124 @@
+/*
+ * 性能计数
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_STATS_H__
+#define __FREE_EASY_STATS_H__
+#include <time.h>
+#include "easy_event.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 后端内部的计数
+ * 多线程使用时用relaxed原子操作累加，POLLER_FLAG_NOLOCK时直接累加
+ */
+typedef struct EasyStats_t
+{
+	PollerStats_t s;
+	int atomic; /* 是否原子累加 */
+	int timing; /* 是否统计阻塞时间 */
+}EasyStats_t;
+
+static inline void StatsInit(EasyStats_t *stats, const PollerOptions_t *options)
+{
+	int flags = options ? options->flags : 0;
+
+	__builtin_memset(&stats->s, 0, sizeof(PollerStats_t));
+	stats->atomic = !(flags & POLLER_FLAG_NOLOCK);
+	stats->timing = !!(flags & POLLER_FLAG_STATS_TIME);
+}
+
+static inline void StatsAdd(EasyStats_t *stats, unsigned long long *counter, unsigned long long n)
+{
+	if (stats->atomic)
+		__atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+	else
+		*counter += n;
+}
+
+/*
+ * 单调时钟(ns)
+ */
+static inline long long StatsNow(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*
+ * 等待开始
+ * return：开始时间，不统计时间时为0
+ */
+static inline long long StatsWaitBegin(const EasyStats_t *stats)
+{
+	return stats->timing ? StatsNow() : 0;
+}
+
+/*
+ * 等待系统调用返回，记录一次等待和阻塞时间
+ * begin：StatsWaitBegin()的返回值
+ */
+static inline void StatsWaitEnd(EasyStats_t *stats, long long begin)
+{
+	if (stats->timing)
+		StatsAdd(stats, &stats->s.blockedNs, StatsNow() - begin);
+	StatsAdd(stats, &stats->s.waits, 1);
+}
+
+/*
+ * 记录一次等待返回给调用者的事件个数
+ * nums：事件个数，出错时为负数
+ */
+static inline void StatsBatch(EasyStats_t *stats, int nums)
+{
+	if (nums <= 0)
+	{
+		StatsAdd(stats, &stats->s.emptyWaits, 1);
+		return;
+	}
+
+	StatsAdd(stats, &stats->s.events, nums);
+
+	unsigned long long max = __atomic_load_n(&stats->s.maxBatch, __ATOMIC_RELAXED);
+	while ((unsigned long long)nums > max)
+	{
+		if (!stats->atomic)
+		{
+			stats->s.maxBatch = nums;
+			break;
+		}
+		if (__atomic_compare_exchange_n(&stats->s.maxBatch, &max, nums, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			break;
+	}
+}
+
+/*
+ * 读取计数，各字段分别读取，不保证相互一致
+ */
+static inline void StatsRead(const EasyStats_t *stats, PollerStats_t *out)
+{
+	out->waits = __atomic_load_n(&stats->s.waits, __ATOMIC_RELAXED);
+	out->emptyWaits = __atomic_load_n(&stats->s.emptyWaits, __ATOMIC_RELAXED);
+	out->events = __atomic_load_n(&stats->s.events, __ATOMIC_RELAXED);
+	out->maxBatch = __atomic_load_n(&stats->s.maxBatch, __ATOMIC_RELAXED);
+	out->ctlCalls = __atomic_load_n(&stats->s.ctlCalls, __ATOMIC_RELAXED);
+	out->addFailures = __atomic_load_n(&stats->s.addFailures, __ATOMIC_RELAXED);
+	out->blockedNs = __atomic_load_n(&stats->s.blockedNs, __ATOMIC_RELAXED);
+	out->lockHeldNs = __atomic_load_n(&stats->s.lockHeldNs, __ATOMIC_RELAXED);
+	out->spinHits = __atomic_load_n(&stats->s.spinHits, __ATOMIC_RELAXED);
+	out->spinBlocks = __atomic_load_n(&stats->s.spinBlocks, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,73 @@
+/*
+ * 无锁任务队列实现
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#include <stddef.h>
+#include "easy_task.h"
+
+/*
+ * 初始化队列
+ */
+void TaskQueueInit(EasyTaskQueue_t *queue)
+{
+	queue->stub.next = NULL;
+	queue->head = &queue->stub;
+	queue->tail = &queue->stub;
+}
+
+/*
+ * 投递任务，任意线程可调用
+ */
+void TaskQueuePush(EasyTaskQueue_t *queue, EasyTask_t *task)
+{
+	__atomic_store_n(&task->next, NULL, __ATOMIC_RELAXED);
+
+	/* 先占住队尾，再把前一个节点链接过来 */
+	EasyTask_t *prev = __atomic_exchange_n(&queue->head, task, __ATOMIC_ACQ_REL);
+	__atomic_store_n(&prev->next, task, __ATOMIC_RELEASE);
+}
+
+/*
+ * 取出任务，只能由消费者线程调用
+ * return：任务，队列为空返回NULL
+ */
+EasyTask_t *TaskQueuePop(EasyTaskQueue_t *queue)
+{
+	EasyTask_t *tail = queue->tail;
+	EasyTask_t *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+	if (tail == &queue->stub) /* 跳过哨兵 */
+	{
+		if (!next)
+			return NULL;
+
+		queue->tail = next;
+		tail = next;
+		next = __atomic_load_n(&next->next, __ATOMIC_ACQUIRE);
+	}
+
+	if (next)
+	{
+		queue->tail = next;
+		return tail;
+	}
+
+	/* tail是最后一个节点，或者投递者还没有完成链接 */
+	if (tail != __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+		return NULL;
+
+	/* 重新放入哨兵，才能取出最后一个节点 */
+	TaskQueuePush(queue, &queue->stub);
+
+	next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	if (next)
+	{
+		queue->tail = next;
+		return tail;
+	}
+
+	return NULL;
+}
+
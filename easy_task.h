@@ -0,0 +1,60 @@
+/*
+ * 无锁任务队列声明
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_TASK_H__
+#define __FREE_EASY_TASK_H__
+#include "easy_event.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 任务节点，由投递者分配，执行后由消费者释放
+ */
+typedef struct EasyTask_t
+{
+	struct EasyTask_t *next;
+	EasyTaskFunc func; /* 任务函数 */
+	void *arg; /* 任务参数 */
+}EasyTask_t;
+
+/*
+ * 多生产者单消费者队列(Vyukov MPSC)
+ * 投递只有一次原子交换，不加锁；取出只能在一个线程中进行
+ */
+typedef struct EasyTaskQueue_t
+{
+	EasyTask_t *head; /* 生产者端，最后投递的节点 */
+	char pad[64 - sizeof(EasyTask_t *)]; /* 生产者与消费者不共享缓存行 */
+	EasyTask_t *tail; /* 消费者端，下一个取出的节点 */
+	EasyTask_t stub; /* 哨兵 */
+}EasyTaskQueue_t;
+
+/*
+ * 初始化队列
+ */
+void TaskQueueInit(EasyTaskQueue_t *queue);
+
+/*
+ * 投递任务，任意线程可调用
+ */
+void TaskQueuePush(EasyTaskQueue_t *queue, EasyTask_t *task);
+
+/*
+ * 取出任务，只能由消费者线程调用
+ * 投递者正在链接节点时可能暂时取不到，投递完成后可以取到
+ * return：任务，队列为空返回NULL
+ */
+EasyTask_t *TaskQueuePop(EasyTaskQueue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
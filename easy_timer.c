@@ -0,0 +1,304 @@
+/*
+ * 分层时间轮实现
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "easy_timer.h"
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_SPAN (1LL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) /* 时间轮覆盖的时长(ms) */
+
+/*
+ * 分配节点
+ * return：节点下标，失败返回-1
+ */
+static int TimerNodeAlloc(EasyTimerWheel_t *wheel)
+{
+	if (wheel->freeHead < 0) /* 扩容 */
+	{
+		int count = wheel->nodeCount ? wheel->nodeCount * 2 : 64;
+		EasyTimerNode_t *nodes = (EasyTimerNode_t *)realloc(wheel->nodes, count * sizeof(EasyTimerNode_t));
+		if (!nodes)
+			return -1;
+
+		int i = wheel->nodeCount;
+		for (; i < count; i++)
+		{
+			nodes[i].next = (i + 1 < count) ? (i + 1) : -1;
+			nodes[i].slot = -1;
+			nodes[i].gen = 0;
+		}
+
+		wheel->freeHead = wheel->nodeCount;
+		wheel->nodes = nodes;
+		wheel->nodeCount = count;
+	}
+
+	int idx = wheel->freeHead;
+	wheel->freeHead = wheel->nodes[idx].next;
+	wheel->nodes[idx].gen++;
+	return idx;
+}
+
+/*
+ * 释放节点
+ */
+static void TimerNodeFree(EasyTimerWheel_t *wheel, int idx)
+{
+	wheel->nodes[idx].slot = -1;
+	wheel->nodes[idx].next = wheel->freeHead;
+	wheel->freeHead = idx;
+}
+
+/*
+ * 按到期时间把节点挂到对应的槽
+ */
+static void TimerLink(EasyTimerWheel_t *wheel, int idx)
+{
+	EasyTimerNode_t *node = &wheel->nodes[idx];
+	long long expire = node->expire;
+	long long delta = expire - wheel->current;
+	int level = 0;
+
+	if (delta < 0) /* 已过期，放到当前槽 */
+		expire = wheel->current;
+	else if (delta >= TIMER_WHEEL_SPAN) /* 超出范围，放到最高层，下放时重新计算 */
+		expire = wheel->current + TIMER_WHEEL_SPAN - 1;
+
+	delta = expire - wheel->current;
+	while ((level < TIMER_WHEEL_LEVELS - 1) && (delta >= (1LL << (TIMER_WHEEL_BITS * (level + 1)))))
+		level++;
+
+	int index = (int)((expire >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+	int slot = level * TIMER_WHEEL_SLOTS + index;
+
+	node->slot = slot;
+	node->prev = -1;
+	node->next = wheel->heads[slot];
+	if (node->next >= 0)
+		wheel->nodes[node->next].prev = idx;
+	wheel->heads[slot] = idx;
+	wheel->bitmap[level] |= 1ULL << index;
+}
+
+/*
+ * 把节点从所在的槽摘下
+ */
+static void TimerUnlink(EasyTimerWheel_t *wheel, int idx)
+{
+	EasyTimerNode_t *node = &wheel->nodes[idx];
+	int slot = node->slot;
+
+	if (node->prev >= 0)
+		wheel->nodes[node->prev].next = node->next;
+	else
+		wheel->heads[slot] = node->next;
+
+	if (node->next >= 0)
+		wheel->nodes[node->next].prev = node->prev;
+
+	if (wheel->heads[slot] < 0)
+		wheel->bitmap[slot / TIMER_WHEEL_SLOTS] &= ~(1ULL << (slot & TIMER_WHEEL_MASK));
+}
+
+/*
+ * 把高层一个槽中的定时器按剩余时间重新挂到低层
+ * return：该槽的下标
+ */
+static int TimerCascade(EasyTimerWheel_t *wheel, int level)
+{
+	int index = (int)((wheel->current >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+	int slot = level * TIMER_WHEEL_SLOTS + index;
+	int idx = wheel->heads[slot], next = -1;
+
+	wheel->heads[slot] = -1;
+	wheel->bitmap[level] &= ~(1ULL << index);
+
+	for (; idx >= 0; idx = next)
+	{
+		next = wheel->nodes[idx].next;
+		TimerLink(wheel, idx);
+	}
+
+	return index;
+}
+
+/*
+ * 初始化时间轮
+ * now：当前时间(ms)
+ */
+void TimerWheelInit(EasyTimerWheel_t *wheel, long long now)
+{
+	int i = 0;
+
+	memset(wheel, 0, sizeof(EasyTimerWheel_t));
+	for (; i < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; i++)
+		wheel->heads[i] = -1;
+
+	wheel->current = now;
+	wheel->freeHead = -1;
+}
+
+/*
+ * 释放时间轮
+ */
+void TimerWheelDestroy(EasyTimerWheel_t *wheel)
+{
+	if (wheel->nodes)
+		free(wheel->nodes);
+	wheel->nodes = NULL;
+	wheel->nodeCount = 0;
+	wheel->freeHead = -1;
+	wheel->count = 0;
+}
+
+/*
+ * 添加定时器
+ * now：当前时间(ms)，时间轮为空时从这里重新开始计时，不必逐槽追赶
+ * expire：到期时间(ms)，已经过去的时间按下一个未处理的时刻(最多晚1ms)到期
+ * userData：到期时随事件返回
+ * return：定时器id(>0)，失败返回-1
+ */
+long long TimerWheelAdd(EasyTimerWheel_t *wheel, long long now, long long expire, void *userData)
+{
+	int idx = TimerNodeAlloc(wheel);
+	if (idx < 0)
+		return -1;
+
+	if (wheel->count == 0)
+		wheel->current = now;
+
+	wheel->nodes[idx].expire = expire;
+	wheel->nodes[idx].userData = userData;
+	TimerLink(wheel, idx);
+	wheel->count++;
+
+	/* 高位为序号，低位为下标+1 */
+	return ((long long)(wheel->nodes[idx].gen & 0x7fffffff) << 32) | (unsigned int)(idx + 1);
+}
+
+/*
+ * 删除定时器
+ * id：TimerWheelAdd()返回的id
+ * return：0 on success，-1 on fail(不存在或已到期)
+ */
+int TimerWheelCancel(EasyTimerWheel_t *wheel, long long id)
+{
+	int idx = (int)(id & 0xffffffff) - 1;
+	if (id <= 0 || idx < 0 || idx >= wheel->nodeCount)
+		return -1;
+
+	EasyTimerNode_t *node = &wheel->nodes[idx];
+	if (node->slot < 0 || (node->gen & 0x7fffffff) != (unsigned int)(id >> 32))
+		return -1;
+
+	TimerUnlink(wheel, idx);
+	TimerNodeFree(wheel, idx);
+	wheel->count--;
+	return 0;
+}
+
+/*
+ * 处理到期的定时器
+ * now：当前时间(ms)
+ * events：保存到期事件的数组
+ * maxevents：events数组大小，写满后剩余的留到下次
+ * return：写入的事件个数
+ */
+int TimerWheelExpire(EasyTimerWheel_t *wheel, long long now, EasyEvent_t *events, int maxevents)
+{
+	unsigned long long bits = 0;
+	long long target = 0;
+	int nums = 0, index = 0, level = 0, idx = -1;
+
+	while ((wheel->current <= now) && (nums < maxevents) && (wheel->count > 0))
+	{
+		index = (int)(wheel->current & TIMER_WHEEL_MASK);
+
+		/* 第0层转完一圈，逐级下放高层的槽 */
+		if (index == 0)
+		{
+			for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
+			{
+				if (TimerCascade(wheel, level) != 0)
+					break;
+			}
+		}
+
+		/* 当前槽中的都已到期 */
+		while ((nums < maxevents) && (idx = wheel->heads[index]) >= 0)
+		{
+			TimerUnlink(wheel, idx);
+
+			events[nums].fd = -1;
+			events[nums].event = 0;
+			events[nums].retEvent = EVENT_TIMER;
+			events[nums].userData = wheel->nodes[idx].userData;
+			nums++;
+
+			TimerNodeFree(wheel, idx);
+			wheel->count--;
+		}
+
+		if (wheel->heads[index] >= 0) /* events已满，下次继续 */
+			break;
+
+		wheel->current++;
+
+		/* 跳过本圈中间的空槽，下一圈开始时需要下放，不能跳过 */
+		if ((wheel->current <= now) && (wheel->current & TIMER_WHEEL_MASK))
+		{
+			bits = wheel->bitmap[0] & (~0ULL << (wheel->current & TIMER_WHEEL_MASK));
+			target = bits ? ((wheel->current & ~(long long)TIMER_WHEEL_MASK) + __builtin_ctzll(bits))
+				: ((wheel->current | TIMER_WHEEL_MASK) + 1);
+			wheel->current = (target > now + 1) ? (now + 1) : target;
+		}
+	}
+
+	/* 没有定时器时直接追上当前时间 */
+	if (wheel->count == 0 && wheel->current <= now)
+		wheel->current = now + 1;
+
+	return nums;
+}
+
+/*
+ * 最早可能到期的时间
+ * 高层的槽返回下放的时刻，可能早于实际到期时间
+ * return：时间(ms)，没有定时器返回-1
+ */
+long long TimerWheelNext(const EasyTimerWheel_t *wheel)
+{
+	unsigned long long bits = 0, rot = 0;
+	long long best = -1, block = 0, tick = 0;
+	int level = 0, shift = 0, start = 0, index = 0;
+
+	if (wheel->count == 0)
+		return -1;
+
+	for (; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		bits = wheel->bitmap[level];
+		if (!bits)
+			continue;
+
+		/* 本层槽对应的时刻：第一个不早于current、且是本层槽宽整数倍的块 */
+		shift = TIMER_WHEEL_BITS * level;
+		block = level ? ((wheel->current + (1LL << shift) - 1) >> shift) : wheel->current;
+		start = (int)(block & TIMER_WHEEL_MASK);
+
+		rot = bits & (~0ULL << start);
+		index = rot ? __builtin_ctzll(rot) : (__builtin_ctzll(bits) + TIMER_WHEEL_SLOTS);
+		tick = ((block & ~(long long)TIMER_WHEEL_MASK) + index) << shift;
+
+		/* 先加入的高层定时器可能早于后加入的低层定时器，各层都要比较 */
+		if (best < 0 || tick < best)
+			best = tick;
+	}
+
+	return best;
+}
+
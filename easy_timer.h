@@ -0,0 +1,97 @@
+/*
+ * 分层时间轮声明
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_TIMER_H__
+#define __FREE_EASY_TIMER_H__
+#include "easy_event.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS) /* 每层槽数 */
+#define TIMER_WHEEL_LEVELS 5 /* 层数，1ms精度下覆盖2^30ms(约12天)，更远的到期后重新计算 */
+
+/*
+ * 定时器节点，按下标链接，节点数组扩容后下标不变
+ */
+typedef struct EasyTimerNode_t
+{
+	long long expire; /* 到期时间(ms) */
+	void *userData; /* 到期时随事件返回 */
+	int prev, next; /* 同槽链表 */
+	int slot; /* 所在的槽，-1表示空闲 */
+	unsigned int gen; /* 节点每次复用加1，与下标组成定时器id */
+}EasyTimerNode_t;
+
+/*
+ * 分层时间轮：添加/删除O(1)，到期处理按槽批量进行
+ * 第0层每槽1ms，第n层每槽64^n ms；高层的槽轮到时逐级下放
+ * 时间轮本身不加锁，由调用者保证互斥
+ */
+typedef struct EasyTimerWheel_t
+{
+	long long current; /* 下一个待处理的时刻(ms) */
+	int heads[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS]; /* 各槽链表头 */
+	unsigned long long bitmap[TIMER_WHEEL_LEVELS]; /* 非空槽位图 */
+	EasyTimerNode_t *nodes; /* 节点数组 */
+	int nodeCount; /* nodes数组大小 */
+	int freeHead; /* 空闲节点链表 */
+	int count; /* 未到期的定时器个数 */
+}EasyTimerWheel_t;
+
+/*
+ * 初始化时间轮
+ * now：当前时间(ms)
+ */
+void TimerWheelInit(EasyTimerWheel_t *wheel, long long now);
+
+/*
+ * 释放时间轮
+ */
+void TimerWheelDestroy(EasyTimerWheel_t *wheel);
+
+/*
+ * 添加定时器
+ * now：当前时间(ms)，时间轮为空时从这里重新开始计时，不必逐槽追赶
+ * expire：到期时间(ms)，已经过去的时间按下一个未处理的时刻(最多晚1ms)到期
+ * userData：到期时随事件返回
+ * return：定时器id(>0)，失败返回-1
+ */
+long long TimerWheelAdd(EasyTimerWheel_t *wheel, long long now, long long expire, void *userData);
+
+/*
+ * 删除定时器
+ * id：TimerWheelAdd()返回的id
+ * return：0 on success，-1 on fail(不存在或已到期)
+ */
+int TimerWheelCancel(EasyTimerWheel_t *wheel, long long id);
+
+/*
+ * 处理到期的定时器
+ * 每个到期的定时器写入一个事件：fd为-1，retEvent为EVENT_TIMER，userData为添加时的用户数据
+ * now：当前时间(ms)
+ * events：保存到期事件的数组
+ * maxevents：events数组大小，写满后剩余的留到下次
+ * return：写入的事件个数
+ */
+int TimerWheelExpire(EasyTimerWheel_t *wheel, long long now, EasyEvent_t *events, int maxevents);
+
+/*
+ * 最早可能到期的时间
+ * 高层的槽返回下放的时刻，可能早于实际到期时间
+ * return：时间(ms)，没有定时器返回-1
+ */
+long long TimerWheelNext(const EasyTimerWheel_t *wheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,403 @@
+/*
+ * 零拷贝转发实现
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#define _GNU_SOURCE 1 // for splice, pipe2, F_SETPIPE_SZ
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include "easy_transfer.h"
+
+#define TRANSFER_CHUNK (1 << 30) /* 单次sendfile/splice的最大字节数 */
+#define TRANSFER_PIPE_SIZE (1 << 20) /* 内部pipe期望的容量，受/proc/sys/fs/pipe-max-size限制 */
+#define TRANSFER_BUDGET (4 << 20) /* 每次回调最多转发的字节数，避免大文件长时间占住事件循环 */
+
+/*
+ * fd在事件循环中的状态(watchIn/watchOut)
+ */
+#define TRANSFER_WATCH_NONE 0 /* 未注册 */
+#define TRANSFER_WATCH_ON 1 /* 已注册并监听事件 */
+#define TRANSFER_WATCH_PAUSED 2 /* 已注册，事件为0，背压切换时只修改事件 */
+
+/*
+ * TransferHandle具体结构
+ */
+typedef struct EasyTransfer_t
+{
+	EventLoopHandle loop;
+	int inFd; /* 源fd，sendfile时为文件 */
+	int outFd; /* 目标fd */
+	int pipeFd[2]; /* splice的内部pipe，sendfile时为-1 */
+	int pipeSize; /* 内部pipe容量 */
+	long long pipeBytes; /* 已读入内部pipe尚未写出的字节数 */
+	off_t offset; /* sendfile的文件偏移 */
+	int useOffset; /* sendfile使用offset，否则使用文件当前位置 */
+	long long remaining; /* 还要读入的字节数，<0表示直到结束 */
+	long long bytes; /* 已写入目标fd的字节数 */
+	int eof; /* 源端已结束 */
+	int watchIn; /* inFd的EVENT_READ，TRANSFER_WATCH_XXX */
+	int watchOut; /* outFd的EVENT_WRITE，TRANSFER_WATCH_XXX */
+	int finished; /* 已结束，不再回调 */
+	TransferHandler handler;
+	void *ctx;
+}EasyTransfer_t;
+
+/*
+ * 设置非阻塞
+ * return：0 on success，-1 on fail
+ */
+static int TransferNonBlock(int fd)
+{
+	int flags = fcntl(fd, F_GETFL);
+	if (flags < 0)
+		return -1;
+	return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/*
+ * 按需要监听或暂停fd，只在状态变化时调用事件循环
+ * 背压切换时fd保持注册，只修改事件，不再反复删除和添加
+ * watched：当前状态，TRANSFER_WATCH_XXX
+ * want：是否需要监听
+ * return：0 on success，-1 on fail
+ */
+static int TransferWatch(EasyTransfer_t *trans, int fd, int events, int *watched, int want,
+	EventLoopHandler handler)
+{
+	if (want)
+	{
+		if (*watched == TRANSFER_WATCH_ON)
+			return 0;
+
+		if (*watched == TRANSFER_WATCH_PAUSED)
+		{
+			if (EventLoopModify(trans->loop, fd, events) < 0)
+				return -1;
+		}
+		else if (EventLoopAdd(trans->loop, fd, events, handler, trans) < 0)
+			return -1;
+
+		*watched = TRANSFER_WATCH_ON;
+		return 0;
+	}
+
+	if (*watched != TRANSFER_WATCH_ON)
+		return 0;
+
+	if (EventLoopModify(trans->loop, fd, 0) == 0)
+		*watched = TRANSFER_WATCH_PAUSED;
+	else
+	{
+		EventLoopRemove(trans->loop, fd);
+		*watched = TRANSFER_WATCH_NONE;
+	}
+	return 0;
+}
+
+/*
+ * 暂停的fd仍会报告挂断和错误，收到时删除，避免水平触发下一直报告
+ */
+static void TransferUnpause(EasyTransfer_t *trans, int fd, int *watched)
+{
+	if (*watched != TRANSFER_WATCH_PAUSED)
+		return;
+
+	EventLoopRemove(trans->loop, fd);
+	*watched = TRANSFER_WATCH_NONE;
+}
+
+/*
+ * 结束转发并回调，回调中可能销毁，之后不能再访问trans
+ * result：0或-errno
+ */
+static void TransferFinish(EasyTransfer_t *trans, int result)
+{
+	if (trans->watchIn)
+		EventLoopRemove(trans->loop, trans->inFd);
+	if (trans->watchOut)
+		EventLoopRemove(trans->loop, trans->outFd);
+	trans->watchIn = TRANSFER_WATCH_NONE;
+	trans->watchOut = TRANSFER_WATCH_NONE;
+	trans->finished = 1;
+
+	trans->handler(trans, result, trans->ctx);
+}
+
+/*
+ * 本次要转发的字节数
+ */
+static size_t TransferChunk(const EasyTransfer_t *trans, long long limit)
+{
+	if (trans->remaining >= 0 && trans->remaining < limit)
+		return (size_t)trans->remaining;
+	return (size_t)limit;
+}
+
+/*
+ * sendfile的事件回调：outFd可写时一直发送，直到写满、发完或用完本次预算
+ * 写满时保持监听EVENT_WRITE，可写后继续
+ */
+static void TransferOnSendFile(EventLoopHandle loop, int fd, int events, void *ctx)
+{
+	EasyTransfer_t *trans = (EasyTransfer_t *)ctx;
+	long long budget = TRANSFER_BUDGET;
+	ssize_t n = 0;
+
+	(void)loop;
+	(void)fd;
+	(void)events;
+
+	if (trans->finished)
+		return;
+
+	while (budget > 0)
+	{
+		if (trans->remaining == 0)
+			break;
+
+		n = sendfile(trans->outFd, trans->inFd, trans->useOffset ? &trans->offset : NULL,
+			TransferChunk(trans, TRANSFER_CHUNK));
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return;
+
+			TransferFinish(trans, -errno);
+			return;
+		}
+
+		if (n == 0) /* 文件已到末尾 */
+		{
+			trans->eof = 1;
+			break;
+		}
+
+		trans->bytes += n;
+		if (trans->remaining > 0)
+			trans->remaining -= n;
+		budget -= n;
+	}
+
+	if (trans->eof || trans->remaining == 0)
+		TransferFinish(trans, 0);
+}
+
+/*
+ * splice的事件回调：先把内部pipe中的数据写到outFd，pipe空了再从inFd读入
+ * outFd写满时只监听outFd的EVENT_WRITE，不再读入，对端慢时自然形成背压；
+ * pipe空且inFd读不到时只监听inFd的EVENT_READ
+ */
+static void TransferOnSplice(EventLoopHandle loop, int fd, int events, void *ctx)
+{
+	EasyTransfer_t *trans = (EasyTransfer_t *)ctx;
+	long long budget = TRANSFER_BUDGET;
+	int wantOut = 0;
+	ssize_t n = 0;
+
+	(void)loop;
+	(void)events;
+
+	if (trans->finished)
+		return;
+
+	TransferUnpause(trans, fd, (fd == trans->inFd) ? &trans->watchIn : &trans->watchOut);
+
+	while (budget > 0)
+	{
+		if (trans->pipeBytes > 0)
+		{
+			n = splice(trans->pipeFd[0], NULL, trans->outFd, NULL, (size_t)trans->pipeBytes,
+				SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+			if (n < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					wantOut = 1;
+					break;
+				}
+
+				TransferFinish(trans, -errno);
+				return;
+			}
+
+			trans->pipeBytes -= n;
+			trans->bytes += n;
+			budget -= n;
+			continue;
+		}
+
+		if (trans->eof || trans->remaining == 0)
+		{
+			TransferFinish(trans, 0);
+			return;
+		}
+
+		n = splice(trans->inFd, NULL, trans->pipeFd[1], NULL, TransferChunk(trans, trans->pipeSize),
+			SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+
+			TransferFinish(trans, -errno);
+			return;
+		}
+
+		if (n == 0)
+		{
+			trans->eof = 1;
+			continue;
+		}
+
+		trans->pipeBytes += n;
+		if (trans->remaining > 0)
+			trans->remaining -= n;
+	}
+
+	if (budget <= 0) /* 用完预算，水平触发下次循环继续 */
+		wantOut = (trans->pipeBytes > 0);
+
+	errno = 0; /* splice可能留下EAGAIN，失败时只取注册的错误码 */
+	if (TransferWatch(trans, trans->inFd, EVENT_READ, &trans->watchIn, !wantOut, TransferOnSplice) < 0
+		|| TransferWatch(trans, trans->outFd, EVENT_WRITE, &trans->watchOut, wantOut, TransferOnSplice) < 0)
+		TransferFinish(trans, errno ? -errno : -ENOMEM);
+}
+
+/*
+ * 分配并初始化
+ */
+static EasyTransfer_t *TransferAlloc(EventLoopHandle loop, int inFd, int outFd, long long count,
+	TransferHandler handler, void *ctx)
+{
+	EasyTransfer_t *trans = (EasyTransfer_t *)calloc(1, sizeof(EasyTransfer_t));
+	if (!trans)
+		return NULL;
+
+	trans->loop = loop;
+	trans->inFd = inFd;
+	trans->outFd = outFd;
+	trans->pipeFd[0] = -1;
+	trans->pipeFd[1] = -1;
+	trans->remaining = count < 0 ? -1 : count;
+	trans->handler = handler;
+	trans->ctx = ctx;
+	return trans;
+}
+
+/*
+ * 用sendfile把文件发送到socket
+ * 注册outFd的EVENT_WRITE，在事件循环中开始发送，回调不会在本函数中发生
+ * return：new handle on success，NULL on fail
+ */
+TransferHandle TransferSendFile(EventLoopHandle loop, int outFd, int fileFd, off_t offset, long long count,
+	TransferHandler handler, void *ctx)
+{
+	if (!loop || outFd < 0 || fileFd < 0 || !handler)
+		return NULL;
+
+	if (TransferNonBlock(outFd) < 0)
+		return NULL;
+
+	EasyTransfer_t *trans = TransferAlloc(loop, fileFd, outFd, count, handler, ctx);
+	if (!trans)
+		return NULL;
+
+	trans->offset = offset;
+	trans->useOffset = (offset >= 0);
+
+	if (EventLoopAdd(loop, outFd, EVENT_WRITE, TransferOnSendFile, trans) < 0)
+	{
+		free(trans);
+		return NULL;
+	}
+	trans->watchOut = TRANSFER_WATCH_ON;
+
+	return trans;
+}
+
+/*
+ * 用splice经内部pipe把inFd的数据转发到outFd
+ * 注册inFd的EVENT_READ，在事件循环中开始转发，回调不会在本函数中发生
+ * return：new handle on success，NULL on fail
+ */
+TransferHandle TransferSplice(EventLoopHandle loop, int inFd, int outFd, long long count,
+	TransferHandler handler, void *ctx)
+{
+	if (!loop || inFd < 0 || outFd < 0 || inFd == outFd || !handler)
+		return NULL;
+
+	if (TransferNonBlock(inFd) < 0 || TransferNonBlock(outFd) < 0)
+		return NULL;
+
+	EasyTransfer_t *trans = TransferAlloc(loop, inFd, outFd, count, handler, ctx);
+	if (!trans)
+		return NULL;
+
+	if (pipe2(trans->pipeFd, O_NONBLOCK | O_CLOEXEC) < 0)
+	{
+		free(trans);
+		return NULL;
+	}
+
+	/* 扩大pipe减少splice次数，失败时使用默认容量 */
+	fcntl(trans->pipeFd[1], F_SETPIPE_SZ, TRANSFER_PIPE_SIZE);
+	trans->pipeSize = fcntl(trans->pipeFd[1], F_GETPIPE_SZ);
+	if (trans->pipeSize <= 0)
+		trans->pipeSize = 65536;
+
+	if (EventLoopAdd(loop, inFd, EVENT_READ, TransferOnSplice, trans) < 0)
+	{
+		close(trans->pipeFd[0]);
+		close(trans->pipeFd[1]);
+		free(trans);
+		return NULL;
+	}
+	trans->watchIn = TRANSFER_WATCH_ON;
+
+	return trans;
+}
+
+/*
+ * 停止转发并销毁，fd从事件循环删除但不关闭
+ * 可以在结束回调中调用：回调之后不再访问转发
+ */
+void TransferDestroy(TransferHandle handle)
+{
+	EasyTransfer_t *trans = (EasyTransfer_t *)handle;
+	if (!trans)
+		return;
+
+	if (trans->watchIn)
+		EventLoopRemove(trans->loop, trans->inFd);
+	if (trans->watchOut)
+		EventLoopRemove(trans->loop, trans->outFd);
+
+	if (trans->pipeFd[0] >= 0)
+		close(trans->pipeFd[0]);
+	if (trans->pipeFd[1] >= 0)
+		close(trans->pipeFd[1]);
+	free(trans);
+}
+
+/*
+ * 已写入目标fd的字节数
+ * return：字节数，失败返回-1
+ */
+long long TransferGetBytes(TransferHandle handle)
+{
+	EasyTransfer_t *trans = (EasyTransfer_t *)handle;
+	if (!trans)
+		return -1;
+
+	return trans->bytes;
+}
@@ -0,0 +1,74 @@
+/*
+ * 零拷贝转发声明
+ * 由事件循环驱动：文件到socket用sendfile，socket到socket经内部pipe用splice，
+ * 数据不经过用户空间，对端写不进去时等EVENT_WRITE后自动继续
+ * sendfile/splice写socket不能带MSG_NOSIGNAL，对端关闭时会产生SIGPIPE，使用前需要忽略SIGPIPE
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_TRANSFER_H__
+#define __FREE_EASY_TRANSFER_H__
+#include <sys/types.h>
+#include "easy_loop.h"
+
+typedef void *TransferHandle;
+
+/*
+ * 转发结束回调，之后不再回调，由用户TransferDestroy()(可以在回调中调用)
+ * transfer：转发句柄
+ * result：0表示完成(传完count字节或源端结束)，失败为-errno
+ * ctx：创建时的上下文
+ */
+typedef void (*TransferHandler)(TransferHandle transfer, int result, void *ctx);
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 用sendfile把文件发送到socket
+ * 转发期间outFd由转发注册到事件循环，不能同时注册其他回调；outFd设置为非阻塞
+ * 只能在运行事件循环的线程中调用，以下函数相同
+ * loop：事件循环句柄
+ * outFd：目标socket
+ * fileFd：源文件，需要支持mmap(普通文件)
+ * offset：文件起始偏移，<0表示从文件当前位置开始并更新文件位置
+ * count：发送的字节数，<0表示发送到文件末尾
+ * handler：结束回调
+ * ctx：回调的上下文
+ * return：new handle on success，NULL on fail
+ */
+TransferHandle TransferSendFile(EventLoopHandle loop, int outFd, int fileFd, off_t offset, long long count,
+	TransferHandler handler, void *ctx);
+
+/*
+ * 用splice经内部pipe把inFd的数据转发到outFd，两端至少一端是socket或pipe
+ * 转发期间两个fd由转发注册到事件循环，不能同时注册其他回调；两个fd设置为非阻塞
+ * inFd：源fd，读到结束(对端关闭)时完成
+ * outFd：目标fd，不能与inFd相同
+ * count：转发的字节数，<0表示直到inFd结束
+ * return：new handle on success，NULL on fail
+ */
+TransferHandle TransferSplice(EventLoopHandle loop, int inFd, int outFd, long long count,
+	TransferHandler handler, void *ctx);
+
+/*
+ * 停止转发并销毁，fd从事件循环删除但不关闭
+ * 内部pipe中已读入尚未写出的数据丢弃
+ */
+void TransferDestroy(TransferHandle handle);
+
+/*
+ * 已写入目标fd的字节数
+ * return：字节数，失败返回-1
+ */
+long long TransferGetBytes(TransferHandle handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,251 @@
+/*
+ * io_uring环形队列封装实现
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "easy_uring.h"
+
+static int SysUringSetup(unsigned int entries, struct io_uring_params *params)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int SysUringEnter(int fd, unsigned int submit, unsigned int waitNr, unsigned int flags, void *arg, size_t argSize)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, submit, waitNr, flags, arg, argSize);
+}
+
+/*
+ * 创建io_uring
+ * entries：SQ大小
+ * cqEntries：CQ大小，0表示SQ的两倍
+ * return：0 on success，-1 on fail
+ */
+int IoUringInit(EasyIoUring_t *ring, unsigned int entries, unsigned int cqEntries)
+{
+	if (!ring)
+		return -1;
+
+	struct io_uring_params params;
+	unsigned int i = 0;
+
+	memset(ring, 0, sizeof(EasyIoUring_t));
+	memset(&params, 0, sizeof(params));
+	ring->ringFd = -1;
+
+	if (cqEntries > 0)
+	{
+		params.flags |= IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+		params.cq_entries = cqEntries;
+	}
+
+	ring->ringFd = SysUringSetup(entries, &params);
+	if (ring->ringFd < 0)
+		return -1;
+
+	/* 等待超时依赖IORING_ENTER_EXT_ARG(5.11) */
+	if (!(params.features & IORING_FEAT_EXT_ARG))
+	{
+		errno = ENOSYS;
+		goto fail;
+	}
+
+	ring->features = params.features;
+	ring->sqEntries = params.sq_entries;
+	ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) /* SQ和CQ共用一块映射 */
+	{
+		if (ring->cqRingSize > ring->sqRingSize)
+			ring->sqRingSize = ring->cqRingSize;
+		ring->cqRingSize = ring->sqRingSize;
+	}
+
+	ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFd, IORING_OFF_SQ_RING);
+	if (ring->sqRing == MAP_FAILED)
+	{
+		ring->sqRing = NULL;
+		goto fail;
+	}
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		ring->cqRing = ring->sqRing;
+	else
+	{
+		ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFd, IORING_OFF_CQ_RING);
+		if (ring->cqRing == MAP_FAILED)
+		{
+			ring->cqRing = NULL;
+			goto fail;
+		}
+	}
+
+	ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = (struct io_uring_sqe *)mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED)
+	{
+		ring->sqes = NULL;
+		goto fail;
+	}
+
+	ring->sqHead = (unsigned int *)((char *)ring->sqRing + params.sq_off.head);
+	ring->sqTail = (unsigned int *)((char *)ring->sqRing + params.sq_off.tail);
+	ring->sqMask = (unsigned int *)((char *)ring->sqRing + params.sq_off.ring_mask);
+	ring->sqArray = (unsigned int *)((char *)ring->sqRing + params.sq_off.array);
+	ring->sqFlags = (unsigned int *)((char *)ring->sqRing + params.sq_off.flags);
+	ring->cqHead = (unsigned int *)((char *)ring->cqRing + params.cq_off.head);
+	ring->cqTail = (unsigned int *)((char *)ring->cqRing + params.cq_off.tail);
+	ring->cqMask = (unsigned int *)((char *)ring->cqRing + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)((char *)ring->cqRing + params.cq_off.cqes);
+
+	/* SQ数组与SQE一一对应，之后不再修改 */
+	for (; i < ring->sqEntries; i++)
+		ring->sqArray[i] = i;
+
+	ring->sqLocal = *ring->sqTail;
+	return 0;
+
+fail:
+	IoUringDestroy(ring);
+	return -1;
+}
+
+/*
+ * 销毁io_uring
+ */
+void IoUringDestroy(EasyIoUring_t *ring)
+{
+	if (!ring)
+		return;
+
+	if (ring->sqes)
+		munmap(ring->sqes, ring->sqesSize);
+	if (ring->cqRing && ring->cqRing != ring->sqRing)
+		munmap(ring->cqRing, ring->cqRingSize);
+	if (ring->sqRing)
+		munmap(ring->sqRing, ring->sqRingSize);
+	ring->sqes = NULL;
+	ring->cqRing = NULL;
+	ring->sqRing = NULL;
+
+	if (ring->ringFd >= 0)
+		close(ring->ringFd);
+	ring->ringFd = -1;
+}
+
+/*
+ * 获取一个空闲的SQE，已清零
+ * SQ已满时先提交已填写的SQE(不等待)
+ * return：SQE，失败返回NULL
+ */
+struct io_uring_sqe *IoUringGetSqe(EasyIoUring_t *ring)
+{
+	unsigned int head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+
+	if (ring->sqLocal - head >= ring->sqEntries) /* 已满，先提交 */
+	{
+		if (IoUringEnter(ring, 0, 0) < 0)
+			return NULL;
+
+		head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+		if (ring->sqLocal - head >= ring->sqEntries)
+			return NULL;
+	}
+
+	struct io_uring_sqe *sqe = &ring->sqes[ring->sqLocal & *ring->sqMask];
+	ring->sqLocal++;
+
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	return sqe;
+}
+
+/*
+ * 发布已填写的SQE，需与IoUringGetSqe()互斥
+ * return：需要提交的SQE个数，上次被信号打断未消费的SQE也计算在内
+ */
+unsigned int IoUringFlush(EasyIoUring_t *ring)
+{
+	__atomic_store_n(ring->sqTail, ring->sqLocal, __ATOMIC_RELEASE);
+	return IoUringPending(ring);
+}
+
+/*
+ * 提交并等待完成事件，只调用一次io_uring_enter
+ * 只访问内核，可以在IoUringFlush()之后不加锁调用
+ * submit：IoUringFlush()的返回值
+ * waitNr：至少等待的完成事件个数，0表示只提交不等待
+ * timeout：等待超时时间(ms)，小于0表示一直等待
+ * return：0 on success(包括超时)，-1 on fail
+ */
+int IoUringWait(EasyIoUring_t *ring, unsigned int submit, unsigned int waitNr, int timeout)
+{
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec ts;
+	unsigned int flags = 0;
+	void *argp = NULL;
+	size_t argSize = 0;
+
+	if (submit == 0 && waitNr == 0) /* 无事可做 */
+		return 0;
+
+	if (waitNr > 0)
+	{
+		flags |= IORING_ENTER_GETEVENTS;
+		if (timeout >= 0)
+		{
+			ts.tv_sec = timeout / 1000;
+			ts.tv_nsec = (timeout % 1000) * 1000000LL;
+
+			memset(&arg, 0, sizeof(arg));
+			arg.sigmask_sz = _NSIG / 8;
+			arg.ts = (unsigned long long)(unsigned long)&ts;
+
+			flags |= IORING_ENTER_EXT_ARG;
+			argp = &arg;
+			argSize = sizeof(arg);
+		}
+	}
+
+	if (SysUringEnter(ring->ringFd, submit, waitNr, flags, argp, argSize) < 0)
+	{
+		/* 超时，或CQ溢出需要先消费完成事件 */
+		if (errno == ETIME || errno == EBUSY || errno == EAGAIN)
+			return 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * 把内核中溢出的完成事件搬到CQ，不等待
+ * return：0 on success，-1 on fail
+ */
+int IoUringReap(EasyIoUring_t *ring)
+{
+	if (SysUringEnter(ring->ringFd, 0, 0, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EBUSY && errno != EAGAIN)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * 提交已填写的SQE，并等待完成事件，提交与等待合并为一次系统调用
+ * waitNr：至少等待的完成事件个数，0表示只提交不等待
+ * timeout：等待超时时间(ms)，小于0表示一直等待
+ * return：0 on success(包括超时)，-1 on fail
+ */
+int IoUringEnter(EasyIoUring_t *ring, unsigned int waitNr, int timeout)
+{
+	return IoUringWait(ring, IoUringFlush(ring), waitNr, timeout);
+}
+
@@ -0,0 +1,137 @@
+/*
+ * io_uring环形队列封装声明
+ * 直接使用系统调用，不依赖liburing
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_URING_H__
+#define __FREE_EASY_URING_H__
+#include <stddef.h>
+#include <linux/io_uring.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * io_uring提交队列(SQ)与完成队列(CQ)
+ * 队列本身不加锁，由调用者保证互斥
+ */
+typedef struct EasyIoUring_t
+{
+	int ringFd; /* io_uring fd */
+	unsigned int features; /* 内核支持的特性，IORING_FEAT_* */
+	unsigned int sqEntries; /* SQ大小 */
+	unsigned int *sqHead; /* 内核消费位置 */
+	unsigned int *sqTail; /* 已发布给内核的位置 */
+	unsigned int *sqMask;
+	unsigned int *sqArray;
+	unsigned int *sqFlags; /* IORING_SQ_* */
+	unsigned int sqLocal; /* 本地填写位置，IoUringEnter()时发布 */
+	struct io_uring_sqe *sqes;
+	unsigned int *cqHead; /* 已消费位置 */
+	unsigned int *cqTail; /* 内核产生位置 */
+	unsigned int *cqMask;
+	struct io_uring_cqe *cqes;
+	void *sqRing; /* mmap区域 */
+	size_t sqRingSize;
+	void *cqRing;
+	size_t cqRingSize;
+	size_t sqesSize;
+}EasyIoUring_t;
+
+/*
+ * 创建io_uring
+ * entries：SQ大小
+ * cqEntries：CQ大小，0表示SQ的两倍
+ * return：0 on success，-1 on fail
+ */
+int IoUringInit(EasyIoUring_t *ring, unsigned int entries, unsigned int cqEntries);
+
+/*
+ * 销毁io_uring
+ */
+void IoUringDestroy(EasyIoUring_t *ring);
+
+/*
+ * 获取一个空闲的SQE，已清零
+ * SQ已满时先提交已填写的SQE(不等待)
+ * return：SQE，失败返回NULL
+ */
+struct io_uring_sqe *IoUringGetSqe(EasyIoUring_t *ring);
+
+/*
+ * 提交已填写的SQE，并等待完成事件，提交与等待合并为一次系统调用
+ * waitNr：至少等待的完成事件个数，0表示只提交不等待
+ * timeout：等待超时时间(ms)，小于0表示一直等待
+ * return：0 on success(包括超时)，-1 on fail
+ */
+int IoUringEnter(EasyIoUring_t *ring, unsigned int waitNr, int timeout);
+
+/*
+ * 发布已填写的SQE，需与IoUringGetSqe()互斥
+ * return：需要提交的SQE个数，上次被信号打断未消费的SQE也计算在内
+ */
+unsigned int IoUringFlush(EasyIoUring_t *ring);
+
+/*
+ * 提交并等待完成事件，只调用一次io_uring_enter
+ * 只访问内核，可以在IoUringFlush()之后不加锁调用
+ * submit：IoUringFlush()的返回值
+ * waitNr：至少等待的完成事件个数，0表示只提交不等待
+ * timeout：等待超时时间(ms)，小于0表示一直等待
+ * return：0 on success(包括超时)，-1 on fail
+ */
+int IoUringWait(EasyIoUring_t *ring, unsigned int submit, unsigned int waitNr, int timeout);
+
+/*
+ * 把内核中溢出的完成事件搬到CQ，不等待
+ * return：0 on success，-1 on fail
+ */
+int IoUringReap(EasyIoUring_t *ring);
+
+/*
+ * CQ满时产生的完成事件暂存在内核中，需要IoUringReap()取回
+ */
+static inline int IoUringOverflow(const EasyIoUring_t *ring)
+{
+	return !!(__atomic_load_n(ring->sqFlags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW);
+}
+
+/*
+ * 获取下一个完成事件，处理后需调用IoUringCqeSeen()
+ * return：完成事件，没有返回NULL
+ */
+static inline struct io_uring_cqe *IoUringPeekCqe(EasyIoUring_t *ring)
+{
+	unsigned int head = *ring->cqHead;
+	if (head == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE))
+		return NULL;
+
+	return &ring->cqes[head & *ring->cqMask];
+}
+
+/*
+ * 标记当前完成事件已处理
+ */
+static inline void IoUringCqeSeen(EasyIoUring_t *ring)
+{
+	__atomic_store_n(ring->cqHead, *ring->cqHead + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * 已填写、内核尚未消费的SQE个数
+ */
+static inline unsigned int IoUringPending(const EasyIoUring_t *ring)
+{
+	return ring->sqLocal - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
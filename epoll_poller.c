@@ -5,32 +5,217 @@
  * 2025 by liuqingshuige
  */
 #include <unistd.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
 #include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include "easy_lock.h"
+#include "easy_registry.h"
+#include "easy_stats.h"
 #include "epoll_poller.h"
 
+/* 内核6.9加入，旧的头文件没有定义 */
+#ifndef EPIOCSPARAMS
+struct epoll_params
+{
+	unsigned int busy_poll_usecs;
+	unsigned short busy_poll_budget;
+	unsigned char prefer_busy_poll;
+	unsigned char __pad;
+};
+#define EPIOCSPARAMS _IOW(0x8A, 0x01, struct epoll_params)
+#endif
+
+#define EPOLL_BUSY_POLL_BUDGET 8 /* 内核默认的忙轮询包数 */
+
+/*
+ * fd索引项的状态标志(EasyFdEntry_t.state)
+ */
+#ifndef EPOLLEXCLUSIVE /* 4.5以上内核，旧头文件没有定义 */
+#define EPOLLEXCLUSIVE (1u << 28)
+#endif
+
+#define EPOLL_STATE_APPLIED 1 /* fd已添加到内核，applied为内核中的事件 */
+#define EPOLL_STATE_PENDING 2 /* fd在changeList中 */
+#define EPOLL_STATE_FORCE 4 /* 提交时即使事件不变也要EPOLL_CTL_MOD(重新激活ONESHOT) */
+#define EPOLL_STATE_RESET 8 /* 提交前fd曾被删除，内核中的可能已是另一个文件，需要先删除再添加 */
+
 /*
  * EpollHandle具体结构
  */
 typedef struct EasyEpoll_t
 {
 	int epollFd; /* epoll操作fd */
-	int eventCapacity; /* eventList数组容量 */
-	int eventSize; /* eventList数组当前元素个数 */
-	EasyEvent_t *eventList;
-	pthread_mutex_t mutex;
+	int changeMode; /* 是否为POLLER_FLAG_CHANGELIST模式 */
+	int *changeList; /* 待提交的fd */
+	int changeSize; /* changeList当前元素个数 */
+	int changeCapacity; /* changeList数组容量 */
+	EasyRegistry_t reg; /* 已注册的fd */
+	EasyLock_t lock; /* POLLER_FLAG_NOLOCK时不启用 */
+	EasyStats_t stats; /* 性能计数 */
 }EasyEpoll_t;
 
+/*
+ * EventType_e转换为epoll事件
+ */
+static uint32_t EpollEvents(int event)
+{
+	uint32_t events = 0;
+
+	if (event & EVENT_READ) events |= EPOLLIN;
+	if (event & EVENT_WRITE) events |= EPOLLOUT;
+	if (event & EVENT_ERROR) events |= EPOLLERR;
+	if (event & EVENT_EDGE) events |= EPOLLET;
+	if (event & EVENT_ONESHOT) events |= EPOLLONESHOT;
+	if (event & EVENT_EXCLUSIVE) events |= EPOLLEXCLUSIVE;
+
+	return events;
+}
+
+/*
+ * 调用epoll_ctl并计数
+ */
+static int EpollCtl(EasyEpoll_t *ep, int op, int fd, struct epoll_event *ev)
+{
+	StatsAdd(&ep->stats, &ep->stats.s.ctlCalls, 1);
+	return epoll_ctl(ep->epollFd, op, fd, ev);
+}
+
+/*
+ * 重新添加fd：EPOLLEXCLUSIVE只能在EPOLL_CTL_ADD时设置，内核不允许对其EPOLL_CTL_MOD
+ * return：0 on success，-1 on fail
+ */
+static int EpollReAdd(EasyEpoll_t *ep, int fd, struct epoll_event *ev)
+{
+	EpollCtl(ep, EPOLL_CTL_DEL, fd, NULL);
+	return EpollCtl(ep, EPOLL_CTL_ADD, fd, ev);
+}
+
+/*
+ * changelist模式：记录fd的变更，等待事件前统一提交
+ * state：附加的状态标志
+ * return：0 on success，-1 on fail
+ */
+static int EpollDefer(EasyEpoll_t *ep, EasyFdEntry_t *entry, int state)
+{
+	if (!(entry->state & EPOLL_STATE_PENDING))
+	{
+		if (ep->changeSize >= ep->changeCapacity) /* 扩容 */
+		{
+			int capacity = ep->changeCapacity ? ep->changeCapacity * 2 : 64;
+			int *list = (int *)realloc(ep->changeList, capacity * sizeof(int));
+			if (!list)
+				return -1;
+
+			ep->changeList = list;
+			ep->changeCapacity = capacity;
+		}
+
+		ep->changeList[ep->changeSize++] = entry->fd;
+	}
+
+	entry->state |= EPOLL_STATE_PENDING | state;
+	return 0;
+}
+
+/*
+ * 提交changeList中fd的最终状态，相互抵消的变更不产生系统调用，调用者已加锁
+ * events：提交失败的fd从Poller中移除，以EVENT_ERROR事件写入events
+ * maxevents：events数组大小，写满后剩余的变更留到下次提交
+ * return：写入events的个数
+ */
+static int EpollFlushLocked(EasyEpoll_t *ep, EasyEvent_t *events, int maxevents)
+{
+	struct epoll_event ev;
+	EasyFdEntry_t *entry = NULL;
+	int i = 0, idx = 0, fd = -1, failed = 0, ret = 0, adding = 0;
+
+	for (; (i < ep->changeSize) && (failed < maxevents); i++)
+	{
+		fd = ep->changeList[i];
+		entry = RegistryEntry(&ep->reg, fd);
+		idx = entry->slot;
+
+		memset(&ev, 0, sizeof(ev));
+		ev.data.ptr = entry;
+		ev.events = (idx < 0) ? 0 : EpollEvents(RegistryAt(&ep->reg, idx)->event);
+
+		/* 删除过的fd、已不再注册的fd或需要修改的独占fd先从内核删除，fd已关闭时删除失败可以忽略 */
+		if ((entry->state & EPOLL_STATE_APPLIED) && (idx < 0 || (entry->state & EPOLL_STATE_RESET)
+			|| (((ev.events | entry->applied) & EPOLLEXCLUSIVE)
+				&& (ev.events != entry->applied || (entry->state & EPOLL_STATE_FORCE)))))
+		{
+			EpollCtl(ep, EPOLL_CTL_DEL, fd, NULL);
+			entry->state &= ~EPOLL_STATE_APPLIED;
+		}
+
+		ret = 0;
+		adding = !(entry->state & EPOLL_STATE_APPLIED);
+		if (idx < 0) /* 已删除，或添加后又删除 */
+			;
+		else if (adding)
+			ret = EpollCtl(ep, EPOLL_CTL_ADD, fd, &ev);
+		else if (ev.events != entry->applied || (entry->state & EPOLL_STATE_FORCE))
+			ret = EpollCtl(ep, EPOLL_CTL_MOD, fd, &ev);
+
+		entry->state &= ~(EPOLL_STATE_PENDING | EPOLL_STATE_FORCE | EPOLL_STATE_RESET);
+		if (idx < 0)
+			continue;
+
+		if (ret < 0) /* 提交失败，移除并报告错误 */
+		{
+			if (adding)
+				StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
+			events[failed].fd = fd;
+			events[failed].retEvent = EVENT_ERROR;
+			events[failed].userData = entry->userData;
+			failed++;
+
+			if (entry->state & EPOLL_STATE_APPLIED)
+				EpollCtl(ep, EPOLL_CTL_DEL, fd, NULL);
+			entry->state &= ~EPOLL_STATE_APPLIED;
+			RegistryRemove(&ep->reg, fd);
+			continue;
+		}
+
+		entry->state |= EPOLL_STATE_APPLIED;
+		entry->applied = ev.events;
+	}
+
+	/* 未提交的留到下次 */
+	memmove(ep->changeList, &ep->changeList[i], (ep->changeSize - i) * sizeof(int));
+	ep->changeSize -= i;
+
+	return failed;
+}
+
 /*
  * 创建Epoll监听器
- * size：待监听的文件fd数量
+ * size：预计监听的文件fd数量，超出时自动扩容
  * return：new handle on success，NULL on fail
  */
 EpollHandle EpollCreate(int size)
 {
-	EasyEpoll_t *ep = (EasyEpoll_t *)malloc(sizeof(EasyEpoll_t));
+	PollerOptions_t options;
+
+	options.size = size;
+	options.flags = 0;
+
+	return EpollCreateEx(&options);
+}
+
+/*
+ * 按参数创建Epoll监听器
+ * options：创建参数，NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+EpollHandle EpollCreateEx(const PollerOptions_t *options)
+{
+	int size = options ? options->size : 0;
+	int flags = options ? options->flags : 0;
+
+	EasyEpoll_t *ep = (EasyEpoll_t *)calloc(1, sizeof(EasyEpoll_t));
 	if (!ep)
 		return NULL;
 
@@ -44,17 +229,17 @@ EpollHandle EpollCreate(int size)
 		return NULL;
 	}
 
-	ep->eventCapacity = size;
-	ep->eventSize = 0;
-	ep->eventList = (EasyEvent_t *)calloc(size, sizeof(EasyEvent_t));
-	if (!ep->eventList)
+	if (RegistryInit(&ep->reg, size) < 0)
 	{
 		close(ep->epollFd);
 		free(ep);
 		return NULL;	
 	}
 
-	pthread_mutex_init(&ep->mutex, NULL);
+	ep->changeMode = !!(flags & POLLER_FLAG_CHANGELIST);
+	EasyLockInit(&ep->lock, !(flags & POLLER_FLAG_NOLOCK));
+	EasyLockTiming(&ep->lock, flags & POLLER_FLAG_STATS_TIME);
+	StatsInit(&ep->stats, options);
 
 	return ep;
 }
@@ -73,11 +258,13 @@ void EpollDestroy(EpollHandle handle)
 		close(ep->epollFd);
 	ep->epollFd = -1;
 
-	if (ep->eventList)
-		free(ep->eventList);
-	ep->eventList = NULL;
+	RegistryDestroy(&ep->reg);
+
+	if (ep->changeList)
+		free(ep->changeList);
+	ep->changeList = NULL;
 
-	pthread_mutex_destroy(&ep->mutex);
+	EasyLockDestroy(&ep->lock);
 
 	free(ep);
 }
@@ -94,104 +281,282 @@ int EpollAddEvent(EpollHandle handle, const EasyEvent_t *event)
 }
 
 /*
- * 删除事件
+ * 批量添加事件，只加一次锁
  * handle：Epoll句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int EpollAddEvents(EpollHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	return EpollUpdateEvents(handle, events, count, results);
+}
+
+/*
+ * 删除事件，调用者已加锁
  * event：待删除事件
  * return：0 on success，-1 on fail
  */
-int EpollRemoveEvent(EpollHandle handle, const EasyEvent_t *event)
+static int EpollRemoveLocked(EasyEpoll_t *ep, const EasyEvent_t *event)
 {
-	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
-	if (!ep || !event || (event->fd < 0))
+	if (!event || (event->fd < 0))
 		return -1;
 
-	pthread_mutex_lock(&ep->mutex);
-
-	EasyEvent_t *eventList = ep->eventList;
 	int fd = event->fd;
-	int idx = 0;
 
 	/* 是否存在该fd */
-	for (; idx < ep->eventSize; idx++)
+	if (RegistryFind(&ep->reg, fd) >= 0)
 	{
-		if (eventList[idx].fd == fd)
+		if (ep->changeMode) /* 只记录，等待事件前提交 */
 		{
-			if (epoll_ctl(ep->epollFd, EPOLL_CTL_DEL, fd, NULL) < 0)
-			{
-				pthread_mutex_unlock(&ep->mutex);
+			EasyFdEntry_t *entry = RegistryEntry(&ep->reg, fd);
+			if (EpollDefer(ep, entry, (entry->state & EPOLL_STATE_APPLIED) ? EPOLL_STATE_RESET : 0) < 0)
 				return -1;
-			}
-
-			/* 从列表中移除 */
-			memmove(&eventList[idx], &eventList[idx+1], (ep->eventSize - idx - 1) * sizeof(EasyEvent_t));
-			ep->eventSize--;
-			break;
 		}
+		else if (EpollCtl(ep, EPOLL_CTL_DEL, fd, NULL) < 0 && errno != EBADF && errno != ENOENT)
+			return -1; /* fd已经关闭时内核已自动删除，仍要从列表中移除，否则复用该fd时无法添加 */
+
+		/* 从列表中移除 */
+		RegistryRemove(&ep->reg, fd);
 	}
 
-	pthread_mutex_unlock(&ep->mutex);
 	return 0;
 }
 
 /*
- * 更新事件
+ * 删除事件
  * handle：Epoll句柄
- * event：事件
+ * event：待删除事件
  * return：0 on success，-1 on fail
  */
-int EpollUpdateEvent(EpollHandle handle, const EasyEvent_t *event)
+int EpollRemoveEvent(EpollHandle handle, const EasyEvent_t *event)
 {
 	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
-	if (!ep || !event || (event->fd < 0))
+	if (!ep)
 		return -1;
 
-	pthread_mutex_lock(&ep->mutex);
+	EasyLock(&ep->lock);
+	int ret = EpollRemoveLocked(ep, event);
+	EasyUnlock(&ep->lock);
+
+	return ret;
+}
+
+/*
+ * 批量删除事件，只加一次锁
+ * handle：Epoll句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int EpollRemoveEvents(EpollHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
+	if (!ep || !events || (count < 0))
+		return -1;
+
+	int i = 0, ret = 0, nums = 0;
+
+	EasyLock(&ep->lock);
+	for (; i < count; i++)
+	{
+		ret = EpollRemoveLocked(ep, &events[i]);
+		if (results)
+			results[i] = ret;
+		if (ret == 0)
+			nums++;
+	}
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
+
+/*
+ * 更新事件，调用者已加锁
+ * event：事件
+ * return：0 on success，-1 on fail
+ */
+static int EpollUpdateLocked(EasyEpoll_t *ep, const EasyEvent_t *event)
+{
+	if (!event || (event->fd < 0))
+		return -1;
+
+	/* EPOLLEXCLUSIVE与EPOLLONESHOT不能同时使用 */
+	if ((event->event & EVENT_EXCLUSIVE) && (event->event & EVENT_ONESHOT))
+		return -1;
 
 	struct epoll_event ev;
-	EasyEvent_t *eventList = ep->eventList;
 	int fd = event->fd;
-	int idx = 0;
+	int idx = RegistryFind(&ep->reg, fd); /* 是否已经存在该fd */
 
-    memset(&ev, 0, sizeof(ev));
-    ev.data.fd = fd;
+	if (ep->changeMode) /* 只记录，等待事件前提交 */
+	{
+		int added = (idx < 0);
 
-	if (event->event & EVENT_READ) ev.events |= EPOLLIN;
-    if (event->event & EVENT_WRITE) ev.events |= EPOLLOUT;
-    if (event->event & EVENT_ERROR) ev.events |= EPOLLERR;
+		if (added)
+		{
+			if ((idx = RegistryInsert(&ep->reg, event)) < 0)
+			{
+				StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
+				return -1;
+			}
+		}
+		else
+			RegistryUpdate(&ep->reg, idx, event);
 
-	/* 是否已经存在该fd */
-	for (; idx < ep->eventSize; idx++)
-	{
-		if (eventList[idx].fd == fd)
-			break;
+		/* ONESHOT重新设置时即使事件不变也要提交，以重新激活 */
+		if (EpollDefer(ep, RegistryEntry(&ep->reg, fd), (event->event & EVENT_ONESHOT) ? EPOLL_STATE_FORCE : 0) < 0)
+		{
+			if (added) /* 新添加的fd没有记录变更，不会提交到内核，从列表中移除 */
+			{
+				StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
+				RegistryRemove(&ep->reg, fd);
+			}
+			return -1;
+		}
+		return 0;
 	}
 
-	if (idx == ep->eventSize) /* 不存在则添加 */
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EpollEvents(event->event);
+
+	if (idx < 0) /* 不存在则添加 */
 	{
-		if (ep->eventSize >= ep->eventCapacity /* 已经满了，TODO：扩容 */
-			|| epoll_ctl(ep->epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+		/* 添加到列表中，容量不够时自动扩容 */
+		if (RegistryInsert(&ep->reg, event) < 0)
 		{
-			pthread_mutex_unlock(&ep->mutex);
+			StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
 			return -1;
 		}
 
-		/* 添加到列表中 */
-		memcpy(&eventList[idx], event, sizeof(EasyEvent_t));
-		ep->eventSize++;
+		ev.data.ptr = RegistryEntry(&ep->reg, fd); /* 索引项地址不变，事件返回时直接取fd和用户数据 */
+		if (EpollCtl(ep, EPOLL_CTL_ADD, fd, &ev) < 0)
+		{
+			StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
+			RegistryRemove(&ep->reg, fd);
+			return -1;
+		}
 	}
-	else /* 存在则更新 */
+	else if ((event->event | RegistryAt(&ep->reg, idx)->event) & EVENT_EXCLUSIVE) /* 独占fd删除后重新添加 */
 	{
-		if (epoll_ctl(ep->epollFd, EPOLL_CTL_MOD, fd, &ev) < 0)
+		ev.data.ptr = RegistryEntry(&ep->reg, fd);
+		if (EpollReAdd(ep, fd, &ev) < 0)
 		{
-			pthread_mutex_unlock(&ep->mutex);
+			/* 恢复原来的事件，仍失败时移除 */
+			ev.events = EpollEvents(RegistryAt(&ep->reg, idx)->event);
+			if (EpollCtl(ep, EPOLL_CTL_ADD, fd, &ev) < 0)
+				RegistryRemove(&ep->reg, fd);
 			return -1;
 		}
 
+		RegistryUpdate(&ep->reg, idx, event);
+	}
+	else /* 存在则更新 */
+	{
+		ev.data.ptr = RegistryEntry(&ep->reg, fd);
+		if (EpollCtl(ep, EPOLL_CTL_MOD, fd, &ev) < 0)
+			return -1;
+
 		/* 更新到列表中 */
-		memcpy(&eventList[idx], event, sizeof(EasyEvent_t));
+		RegistryUpdate(&ep->reg, idx, event);
+	}
+
+	return 0;
+}
+
+/*
+ * 更新事件
+ * handle：Epoll句柄
+ * event：事件
+ * return：0 on success，-1 on fail
+ */
+int EpollUpdateEvent(EpollHandle handle, const EasyEvent_t *event)
+{
+	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
+	if (!ep)
+		return -1;
+
+	EasyLock(&ep->lock);
+	int ret = EpollUpdateLocked(ep, event);
+	EasyUnlock(&ep->lock);
+
+	return ret;
+}
+
+/*
+ * 批量更新事件，只加一次锁
+ * handle：Epoll句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int EpollUpdateEvents(EpollHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
+	if (!ep || !events || (count < 0))
+		return -1;
+
+	int i = 0, ret = 0, nums = 0;
+
+	EasyLock(&ep->lock);
+	for (; i < count; i++)
+	{
+		ret = EpollUpdateLocked(ep, &events[i]);
+		if (results)
+			results[i] = ret;
+		if (ret == 0)
+			nums++;
+	}
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
+
+/*
+ * 重新激活事件
+ * handle：Epoll句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int EpollRearmEvent(EpollHandle handle, const EasyEvent_t *event)
+{
+	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
+	if (!ep || !event || (event->fd < 0))
+		return -1;
+
+	EasyLock(&ep->lock);
+
+	struct epoll_event ev;
+	int fd = event->fd;
+	int idx = RegistryFind(&ep->reg, fd);
+
+	if (idx < 0) /* 未注册 */
+	{
+		EasyUnlock(&ep->lock);
+		return -1;
+	}
+
+	if (ep->changeMode) /* 只记录，等待事件前提交 */
+	{
+		int ret = EpollDefer(ep, RegistryEntry(&ep->reg, fd), EPOLL_STATE_FORCE);
+		EasyUnlock(&ep->lock);
+		return ret;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.data.ptr = RegistryEntry(&ep->reg, fd);
+	ev.events = EpollEvents(RegistryAt(&ep->reg, idx)->event);
+
+	if ((ev.events & EPOLLEXCLUSIVE) ? (EpollReAdd(ep, fd, &ev) < 0) : (EpollCtl(ep, EPOLL_CTL_MOD, fd, &ev) < 0))
+	{
+		EasyUnlock(&ep->lock);
+		return -1;
 	}
 
-	pthread_mutex_unlock(&ep->mutex);
+	EasyUnlock(&ep->lock);
 	return 0;
 }
 
@@ -209,26 +574,42 @@ int EpollWaitEvent(EpollHandle handle, EasyEvent_t *events, int maxevents, int t
 	if (!ep || !events || (maxevents < 1))
 		return -1;
 
-	pthread_mutex_lock(&ep->mutex);
-	int ev_size = ep->eventSize;
-	pthread_mutex_unlock(&ep->mutex);
+	int failed = 0;
+
+	EasyLock(&ep->lock);
+	if (ep->changeSize > 0) /* 阻塞前提交变更 */
+		failed = EpollFlushLocked(ep, events, maxevents);
+	int ev_size = ep->reg.eventSize;
+	EasyUnlock(&ep->lock);
+
+	if (failed > 0) /* 先返回提交失败的fd */
+		return failed;
 
 	if (ev_size == 0) /* 没有事件 */
 		return 0;
 
 	struct epoll_event evs[maxevents];
-	int nums = 0, i = 0, fd = -1, event = 0, revent = 0;
+	EasyFdEntry_t *entry = NULL;
+	int nums = 0, real_nums = 0, i = 0, event = 0, revent = 0;
 
+	long long begin = StatsWaitBegin(&ep->stats);
 	nums = epoll_wait(ep->epollFd, evs, maxevents, timeout);
+	StatsWaitEnd(&ep->stats, begin);
 	if (nums < 0) /* 出错 */
+	{
+		StatsBatch(&ep->stats, nums);
 		return -1;
+	}
 
 	for (i = 0; i < nums; i++)
 	{
 		revent = 0;
-		fd = evs[i].data.fd;
+		entry = (EasyFdEntry_t *)evs[i].data.ptr;
 		event = evs[i].events;
 
+		if (entry->slot < 0) /* epoll_wait返回后已被其他线程删除 */
+			continue;
+
 		if (event & EPOLLIN
 			|| event & EPOLLPRI
 			|| event & EPOLLRDHUP
@@ -239,9 +620,84 @@ int EpollWaitEvent(EpollHandle handle, EasyEvent_t *events, int maxevents, int t
 		if (event & EPOLLERR)
 			revent |= EVENT_ERROR;
 
-		events[i].fd = fd;
-		events[i].retEvent = revent;
+		events[real_nums].fd = entry->fd;
+		events[real_nums].retEvent = revent;
+		events[real_nums].userData = entry->userData;
+		real_nums++;
 	}
 
+	StatsBatch(&ep->stats, real_nums);
+	return real_nums;
+}
+
+/*
+ * 监听事件，直接返回内核的原生事件，不做转换
+ * handle：Epoll句柄
+ * events：保存原生事件的数组
+ * maxevents：events数组大小
+ * timeout：超时时间(ms)
+ * failed：延迟提交模式下保存提交失败的fd
+ * failedNums：提交失败的个数，大于0时不等待，返回0
+ * return：返回原生事件个数，失败返回-1
+ */
+int EpollWaitNative(EpollHandle handle, struct epoll_event *events, int maxevents, int timeout,
+	EasyEvent_t *failed, int *failedNums)
+{
+	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
+	if (!ep || !events || (maxevents < 1) || !failed || !failedNums)
+		return -1;
+
+	EasyLock(&ep->lock);
+	*failedNums = (ep->changeSize > 0) ? EpollFlushLocked(ep, failed, maxevents) : 0;
+	int ev_size = ep->reg.eventSize;
+	EasyUnlock(&ep->lock);
+
+	if (*failedNums > 0 || ev_size == 0)
+		return 0;
+
+	long long begin = StatsWaitBegin(&ep->stats);
+	int nums = epoll_wait(ep->epollFd, events, maxevents, timeout);
+	StatsWaitEnd(&ep->stats, begin);
+	StatsBatch(&ep->stats, nums);
 	return nums;
 }
+
+/*
+ * 获取性能计数
+ * handle：Epoll句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int EpollGetStats(EpollHandle handle, PollerStats_t *stats)
+{
+	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
+	if (!ep || !stats)
+		return -1;
+
+	StatsRead(&ep->stats, stats);
+	stats->lockHeldNs = EasyLockHeldNs(&ep->lock);
+	return 0;
+}
+
+/*
+ * 设置内核忙轮询参数(EPIOCSPARAMS)
+ * 只对开启了NAPI忙轮询的网卡上的socket有效，需要内核6.9以上
+ * handle：Epoll句柄
+ * usecs：忙轮询时间(us)，0表示关闭
+ * budget：每次忙轮询最多处理的包数，<=0使用默认值
+ * return：0 on success，-1 on fail(内核不支持或参数超出权限)
+ */
+int EpollSetBusyPoll(EpollHandle handle, int usecs, int budget)
+{
+	EasyEpoll_t *ep = (EasyEpoll_t *)handle;
+	if (!ep || usecs < 0)
+		return -1;
+
+	struct epoll_params params;
+	memset(&params, 0, sizeof(params));
+	params.busy_poll_usecs = (unsigned int)usecs;
+	params.busy_poll_budget = (budget > 0) ? (unsigned short)budget : EPOLL_BUSY_POLL_BUDGET;
+	params.prefer_busy_poll = (usecs > 0);
+
+	return ioctl(ep->epollFd, EPIOCSPARAMS, &params) < 0 ? -1 : 0;
+}
@@ -10,6 +10,8 @@
 
 typedef void *EpollHandle;
 
+struct epoll_event;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -17,11 +19,18 @@ extern "C"
 
 /*
  * 创建Epoll监听器
- * size：待监听的文件fd数量
+ * size：预计监听的文件fd数量，超出时自动扩容
  * return：new handle on success，NULL on fail
  */
 EpollHandle EpollCreate(int size);
 
+/*
+ * 按参数创建Epoll监听器
+ * options：创建参数，NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+EpollHandle EpollCreateEx(const PollerOptions_t *options);
+
 /*
  * 销毁Epoll监听器
  * handle：EpollCreate()返回的句柄
@@ -38,6 +47,20 @@ void EpollDestroy(EpollHandle handle);
  */
 int EpollWaitEvent(EpollHandle handle, EasyEvent_t *events, int maxevents, int timeout);
 
+/*
+ * 监听事件，直接返回内核的原生事件，不做转换
+ * 原生事件的data.ptr为fd的EasyFdEntry_t，slot<0表示返回后已被删除
+ * handle：Epoll句柄
+ * events：保存原生事件的数组
+ * maxevents：events数组大小
+ * timeout：超时时间(ms)
+ * failed：延迟提交模式下保存提交失败的fd(EVENT_ERROR)，至少maxevents个
+ * failedNums：提交失败的个数，大于0时不等待，返回0
+ * return：返回原生事件个数，失败返回-1
+ */
+int EpollWaitNative(EpollHandle handle, struct epoll_event *events, int maxevents, int timeout,
+	EasyEvent_t *failed, int *failedNums);
+
 /*
  * 添加事件
  * handle：Epoll句柄
@@ -46,6 +69,16 @@ int EpollWaitEvent(EpollHandle handle, EasyEvent_t *events, int maxevents, int t
  */
 int EpollAddEvent(EpollHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量添加事件，只加一次锁
+ * handle：Epoll句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int EpollAddEvents(EpollHandle handle, const EasyEvent_t *events, int count, int *results);
+
 /*
  * 更新事件
  * handle：Epoll句柄
@@ -54,6 +87,16 @@ int EpollAddEvent(EpollHandle handle, const EasyEvent_t *event);
  */
 int EpollUpdateEvent(EpollHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量更新事件，只加一次锁
+ * handle：Epoll句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int EpollUpdateEvents(EpollHandle handle, const EasyEvent_t *events, int count, int *results);
+
 /*
  * 删除事件
  * handle：Epoll句柄
@@ -62,7 +105,42 @@ int EpollUpdateEvent(EpollHandle handle, const EasyEvent_t *event);
  */
 int EpollRemoveEvent(EpollHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量删除事件，只加一次锁
+ * handle：Epoll句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int EpollRemoveEvents(EpollHandle handle, const EasyEvent_t *events, int count, int *results);
+
+/*
+ * 重新激活事件
+ * EVENT_EDGE/EVENT_ONESHOT事件报告后，按注册时的事件重新激活，无需再传入事件
+ * handle：Epoll句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int EpollRearmEvent(EpollHandle handle, const EasyEvent_t *event);
 
+/*
+ * 获取性能计数
+ * handle：Epoll句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int EpollGetStats(EpollHandle handle, PollerStats_t *stats);
+
+/*
+ * 设置内核忙轮询参数(EPIOCSPARAMS)
+ * 只对开启了NAPI忙轮询的网卡上的socket有效，需要内核6.9以上
+ * handle：Epoll句柄
+ * usecs：忙轮询时间(us)，0表示关闭
+ * budget：每次忙轮询最多处理的包数，<=0使用默认值
+ * return：0 on success，-1 on fail(内核不支持或参数超出权限)
+ */
+int EpollSetBusyPoll(EpollHandle handle, int usecs, int budget);
 
 #ifdef __cplusplus
 }
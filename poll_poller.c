@@ -8,45 +8,123 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
 #include <poll.h>
+#include "easy_lock.h"
+#include "easy_registry.h"
+#include "easy_stats.h"
 #include "poll_poller.h"
 
+#define POLL_EVENT_MASK (EVENT_READ | EVENT_WRITE | EVENT_ERROR)
+#define POLL_STACK_FDS 256 /* 加锁模式下快照被占用且不超过该数量时使用栈空间 */
+
 /*
  * PollHandle具体结构
+ * pollList与注册表的事件数组一一对应，只在添加/更新/删除时修改，poll()直接使用
+ * 注册表中事件的retEvent字段记录EVENT_EDGE/EVENT_ONESHOT报告后被禁用的事件
  */
 typedef struct EasyPoll_t
 {
-	int eventCapacity; /* eventList数组容量 */
-	int eventSize; /* eventList数组当前元素个数 */
-	EasyEvent_t *eventList;
-	pthread_mutex_t mutex;
+	EasyRegistry_t reg; /* 已注册的fd */
+	struct pollfd *pollList; /* 传给poll()的数组 */
+	int pollCapacity; /* pollList数组容量 */
+	unsigned int pollGen; /* pollList每次修改加1 */
+	struct pollfd *snapList; /* 加锁模式下的快照，跨等待复用，pollList未修改时不重新拷贝 */
+	int snapCapacity; /* snapList数组容量 */
+	int snapSize; /* 快照中的fd个数 */
+	unsigned int snapGen; /* 快照对应的pollGen */
+	int snapBusy; /* 快照正被一个线程使用，其他线程同时等待时使用临时快照 */
+	int scanStart; /* 上次返回事件被maxevents截断时，下次从这里开始收集 */
+	EasyLock_t lock; /* POLLER_FLAG_NOLOCK时不启用 */
+	EasyStats_t stats; /* 性能计数 */
 }EasyPoll_t;
 
+/*
+ * 按注册表下标idx刷新pollList[idx]
+ */
+static void PollArm(EasyPoll_t *ep, int idx)
+{
+	EasyEvent_t *item = RegistryAt(&ep->reg, idx);
+	struct pollfd *pfd = &ep->pollList[idx];
+	int armed = item->event & ~item->retEvent;
+
+	ep->pollGen++;
+
+	/* 已被全部禁用的fd不参与poll */
+	pfd->fd = (item->retEvent && !(armed & POLL_EVENT_MASK)) ? -1 : item->fd;
+	pfd->events = 0;
+	pfd->revents = 0;
+	if (armed & EVENT_READ) pfd->events |= POLLIN;
+	if (armed & EVENT_WRITE) pfd->events |= POLLOUT;
+	if (armed & EVENT_ERROR) pfd->events |= POLLERR;
+}
+
+/*
+ * 使pollList容量与注册表一致
+ * return：0 on success，-1 on fail
+ */
+static int PollResize(EasyPoll_t *ep)
+{
+	int capacity = ep->reg.eventCapacity;
+	if (capacity == ep->pollCapacity)
+		return 0;
+
+	struct pollfd *list = (struct pollfd *)realloc(ep->pollList, capacity * sizeof(struct pollfd));
+	if (!list)
+		return (capacity < ep->pollCapacity) ? 0 : -1; /* 收缩失败可以继续使用原数组 */
+
+	ep->pollList = list;
+	ep->pollCapacity = capacity;
+	return 0;
+}
+
 /*
  * 创建Poll监听器
- * size：待监听的文件fd数量
+ * size：预计监听的文件fd数量，超出时自动扩容
  * return：new handle on success，NULL on fail
  */
 PollHandle PollCreate(int size)
 {
-	EasyPoll_t *ep = (EasyPoll_t *)malloc(sizeof(EasyPoll_t));
+	PollerOptions_t options;
+
+	options.size = size;
+	options.flags = 0;
+
+	return PollCreateEx(&options);
+}
+
+/*
+ * 按参数创建Poll监听器
+ * options：创建参数，NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+PollHandle PollCreateEx(const PollerOptions_t *options)
+{
+	int size = options ? options->size : 0;
+	int flags = options ? options->flags : 0;
+
+	EasyPoll_t *ep = (EasyPoll_t *)calloc(1, sizeof(EasyPoll_t));
 	if (!ep)
 		return NULL;
 
 	if (size <= 0)
 		size = 1;
 
-	ep->eventCapacity = size;
-	ep->eventSize = 0;
-	ep->eventList = (EasyEvent_t *)calloc(size, sizeof(EasyEvent_t));
-	if (!ep->eventList)
+	if (RegistryInit(&ep->reg, size) < 0)
+	{
+		free(ep);
+		return NULL;
+	}
+
+	if (PollResize(ep) < 0)
 	{
+		RegistryDestroy(&ep->reg);
 		free(ep);
 		return NULL;
 	}
 
-	pthread_mutex_init(&ep->mutex, NULL);
+	EasyLockInit(&ep->lock, !(flags & POLLER_FLAG_NOLOCK));
+	EasyLockTiming(&ep->lock, flags & POLLER_FLAG_STATS_TIME);
+	StatsInit(&ep->stats, options);
 
 	return ep;
 }
@@ -61,11 +139,17 @@ void PollDestroy(PollHandle handle)
 	if (!ep)
 		return;
 
-	if (ep->eventList)
-		free(ep->eventList);
-	ep->eventList = NULL;
+	RegistryDestroy(&ep->reg);
+
+	if (ep->pollList)
+		free(ep->pollList);
+	ep->pollList = NULL;
 
-	pthread_mutex_destroy(&ep->mutex);
+	if (ep->snapList)
+		free(ep->snapList);
+	ep->snapList = NULL;
+
+	EasyLockDestroy(&ep->lock);
 
 	free(ep);
 }
@@ -81,6 +165,42 @@ int PollAddEvent(PollHandle handle, const EasyEvent_t *event)
 	return PollUpdateEvent(handle, event);
 }
 
+/*
+ * 批量添加事件，只加一次锁
+ * handle：Poll句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollAddEvents(PollHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	return PollUpdateEvents(handle, events, count, results);
+}
+
+/*
+ * 删除事件，调用者已加锁
+ * event：待删除事件
+ * return：0 on success，-1 on fail
+ */
+static int PollRemoveLocked(EasyPoll_t *ep, const EasyEvent_t *event)
+{
+	if (!event || (event->fd < 0))
+		return -1;
+
+	/* 从列表中移除，末尾元素移动到空位 */
+	int idx = RegistryRemove(&ep->reg, event->fd);
+	if (idx >= 0)
+	{
+		if (idx != ep->reg.eventSize)
+			ep->pollList[idx] = ep->pollList[ep->reg.eventSize];
+		ep->pollGen++;
+		PollResize(ep);
+	}
+
+	return 0;
+}
+
 /*
  * 删除事件
  * handle：Poll句柄
@@ -90,28 +210,78 @@ int PollAddEvent(PollHandle handle, const EasyEvent_t *event)
 int PollRemoveEvent(PollHandle handle, const EasyEvent_t *event)
 {
 	EasyPoll_t *ep = (EasyPoll_t *)handle;
-	if (!ep || !event || (event->fd < 0))
+	if (!ep)
 		return -1;
 
-	pthread_mutex_lock(&ep->mutex);
+	EasyLock(&ep->lock);
+	int ret = PollRemoveLocked(ep, event);
+	EasyUnlock(&ep->lock);
+
+	return ret;
+}
+
+/*
+ * 批量删除事件，只加一次锁
+ * handle：Poll句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollRemoveEvents(PollHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	EasyPoll_t *ep = (EasyPoll_t *)handle;
+	if (!ep || !events || (count < 0))
+		return -1;
+
+	int i = 0, ret = 0, nums = 0;
+
+	EasyLock(&ep->lock);
+	for (; i < count; i++)
+	{
+		ret = PollRemoveLocked(ep, &events[i]);
+		if (results)
+			results[i] = ret;
+		if (ret == 0)
+			nums++;
+	}
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
+
+/*
+ * 更新事件，调用者已加锁
+ * event：事件
+ * return：0 on success，-1 on fail
+ */
+static int PollUpdateLocked(EasyPoll_t *ep, const EasyEvent_t *event)
+{
+	if (!event || (event->fd < 0))
+		return -1;
 
-	EasyEvent_t *eventList = ep->eventList;
-	int fd = event->fd;
-	int idx = 0;
+	int idx = RegistryFind(&ep->reg, event->fd); /* 是否已经存在该fd */
 
-	/* 是否存在该fd */
-	for (; idx < ep->eventSize; idx++)
+	if (idx < 0) /* 不存在则添加 */
 	{
-		if (eventList[idx].fd == fd)
+		idx = RegistryInsert(&ep->reg, event);
+		if (idx < 0 || PollResize(ep) < 0) /* 内存不足 */
 		{
-			/* 从列表中移除 */
-			memmove(&eventList[idx], &eventList[idx+1], (ep->eventSize - idx - 1) * sizeof(EasyEvent_t));
-			ep->eventSize--;
-			break;
+			StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
+			if (idx >= 0)
+				RegistryRemove(&ep->reg, event->fd);
+			return -1;
 		}
 	}
+	else /* 存在则更新 */
+	{
+		/* 更新到列表中 */
+		RegistryUpdate(&ep->reg, idx, event);
+	}
+
+	RegistryAt(&ep->reg, idx)->retEvent = 0; /* 重新激活 */
+	PollArm(ep, idx);
 
-	pthread_mutex_unlock(&ep->mutex);
 	return 0;
 }
 
@@ -124,46 +294,119 @@ int PollRemoveEvent(PollHandle handle, const EasyEvent_t *event)
 int PollUpdateEvent(PollHandle handle, const EasyEvent_t *event)
 {
 	EasyPoll_t *ep = (EasyPoll_t *)handle;
-	if (!ep || !event || (event->fd < 0))
+	if (!ep)
 		return -1;
 
-	pthread_mutex_lock(&ep->mutex);
+	EasyLock(&ep->lock);
+	int ret = PollUpdateLocked(ep, event);
+	EasyUnlock(&ep->lock);
 
-	EasyEvent_t *eventList = ep->eventList;
-	int fd = event->fd;
-	int idx = 0;
+	return ret;
+}
 
-	/* 是否已经存在该fd */
-	for (; idx < ep->eventSize; idx++)
+/*
+ * 批量更新事件，只加一次锁
+ * handle：Poll句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollUpdateEvents(PollHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	EasyPoll_t *ep = (EasyPoll_t *)handle;
+	if (!ep || !events || (count < 0))
+		return -1;
+
+	int i = 0, ret = 0, nums = 0;
+
+	EasyLock(&ep->lock);
+	for (; i < count; i++)
 	{
-		if (eventList[idx].fd == fd)
-			break;
+		ret = PollUpdateLocked(ep, &events[i]);
+		if (results)
+			results[i] = ret;
+		if (ret == 0)
+			nums++;
 	}
+	EasyUnlock(&ep->lock);
 
-	if (idx == ep->eventSize) /* 不存在则添加 */
+	return nums;
+}
+
+/*
+ * 重新激活事件
+ * handle：Poll句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int PollRearmEvent(PollHandle handle, const EasyEvent_t *event)
+{
+	EasyPoll_t *ep = (EasyPoll_t *)handle;
+	if (!ep || !event || (event->fd < 0))
+		return -1;
+
+	EasyLock(&ep->lock);
+
+	int idx = RegistryFind(&ep->reg, event->fd);
+	if (idx >= 0)
+	{
+		RegistryAt(&ep->reg, idx)->retEvent = 0;
+		PollArm(ep, idx);
+	}
+
+	EasyUnlock(&ep->lock);
+	return (idx < 0) ? -1 : 0;
+}
+
+/*
+ * 取得快照，调用者已加锁
+ * 复用的快照只在pollList修改后重新拷贝，被其他线程占用时拷贝到stack或临时分配的heap
+ * return：快照，失败返回NULL
+ */
+static struct pollfd *PollSnapshot(EasyPoll_t *ep, int ev_size, struct pollfd *stack, struct pollfd **heap)
+{
+	if (ep->snapBusy)
 	{
-		if (ep->eventSize >= ep->eventCapacity) /* 已经满了，TODO：扩容 */
+		if (ev_size > POLL_STACK_FDS)
 		{
-			pthread_mutex_unlock(&ep->mutex);
-			return -1;
+			*heap = (struct pollfd *)malloc(ev_size * sizeof(struct pollfd));
+			if (!*heap)
+				return NULL;
 		}
 
-		/* 添加到列表中 */
-		memcpy(&eventList[idx], event, sizeof(EasyEvent_t));
-		ep->eventSize++;
+		struct pollfd *evs = *heap ? *heap : stack;
+		memcpy(evs, ep->pollList, ev_size * sizeof(struct pollfd));
+		return evs;
 	}
-	else /* 存在则更新 */
+
+	if (ev_size > ep->snapCapacity) /* 只增不减 */
 	{
-		/* 更新到列表中 */
-		memcpy(&eventList[idx], event, sizeof(EasyEvent_t));
+		struct pollfd *list = (struct pollfd *)realloc(ep->snapList, ep->pollCapacity * sizeof(struct pollfd));
+		if (!list)
+			return NULL;
+
+		ep->snapList = list;
+		ep->snapCapacity = ep->pollCapacity;
+		ep->snapSize = -1;
 	}
 
-	pthread_mutex_unlock(&ep->mutex);
-	return 0;
+	if (ep->snapGen != ep->pollGen || ep->snapSize != ev_size)
+	{
+		memcpy(ep->snapList, ep->pollList, ev_size * sizeof(struct pollfd));
+		ep->snapGen = ep->pollGen;
+		ep->snapSize = ev_size;
+	}
+
+	ep->snapBusy = 1;
+	return ep->snapList;
 }
 
 /*
  * 监听事件
+ * 单线程模式直接对pollList调用poll()；加锁模式下其他线程可能同时修改pollList，
+ * 因此对快照poll()，快照在pollList修改后才重新拷贝
+ * 监听的fd个数与maxevents无关，就绪fd超过maxevents时剩余的留到下次返回
  * handle：Poll句柄
  * events：保存触发的事件数组
  * maxevents：events数组大小
@@ -176,61 +419,124 @@ int PollWaitEvent(PollHandle handle, EasyEvent_t *events, int maxevents, int tim
 	if (!ep || !events || (maxevents < 1))
 		return -1;
 
-	struct pollfd evs[maxevents];
-	int nums = 0, real_nums = 0, i = 0, fd = -1, event = 0, revent = 0;
+	struct pollfd stack[ep->lock.enabled ? POLL_STACK_FDS : 1];
+	struct pollfd *evs = ep->pollList, *heap = NULL, *snap = NULL;
+	EasyEvent_t *item = NULL;
+	int direct = !ep->lock.enabled; /* 是否直接使用pollList */
+	int nums = 0, real_nums = 0, i = 0, k = 0, fd = -1, event = 0, revent = 0, idx = 0;
 
-	memset(evs, 0, sizeof(evs));
-	pthread_mutex_lock(&ep->mutex);
-
-	EasyEvent_t *eventList = ep->eventList;
-	int ev_size = (maxevents > ep->eventSize) ? ep->eventSize : maxevents; /* 实际监听fd个数 */
+	EasyLock(&ep->lock);
 
+	int ev_size = ep->reg.eventSize; /* 实际监听fd个数 */
 	if (ev_size == 0) /* 没有事件 */
 	{
-		pthread_mutex_unlock(&ep->mutex);
+		EasyUnlock(&ep->lock);
 		return 0;
 	}
 
-	for (i = 0; i < ev_size; i++) /* 事件填充用于poll */
+	if (!direct) /* 取得快照 */
 	{
-		evs[i].fd = eventList[i].fd;
-		if (eventList[i].event & EVENT_READ) evs[i].events |= POLLIN;
-		if (eventList[i].event & EVENT_WRITE) evs[i].events |= POLLOUT;
-		if (eventList[i].event & EVENT_ERROR) evs[i].events |= POLLERR;
+		evs = PollSnapshot(ep, ev_size, stack, &heap);
+		if (!evs)
+		{
+			EasyUnlock(&ep->lock);
+			return -1;
+		}
+		if (evs == ep->snapList)
+			snap = evs;
 	}
 
-	pthread_mutex_unlock(&ep->mutex);
+	EasyUnlock(&ep->lock);
 
+	long long begin = StatsWaitBegin(&ep->stats);
 	nums = poll(evs, ev_size, timeout);
+	StatsWaitEnd(&ep->stats, begin);
 	if (nums < 0) /* 出错 */
+	{
+		StatsBatch(&ep->stats, nums);
+		if (snap)
+		{
+			EasyLock(&ep->lock);
+			ep->snapBusy = 0;
+			EasyUnlock(&ep->lock);
+		}
+		if (heap)
+			free(heap);
 		return -1;
+	}
+
+	EasyLock(&ep->lock);
 
-	for (i = 0; (i < ev_size) && (nums > 0); i++)
+	int start = (ep->scanStart < ev_size) ? ep->scanStart : 0;
+	for (k = 0; (k < ev_size) && (nums > 0) && (real_nums < maxevents); k++)
 	{
-		revent = 0;
-		fd = evs[i].fd;
+		i = (start + k < ev_size) ? (start + k) : (start + k - ev_size);
 		event = evs[i].revents; /* 返回的事件 */
+		if (event <= 0)
+			continue;
 
-		if (event > 0)
+		revent = 0;
+		fd = evs[i].fd;
+		nums--;
+
+		if (event & POLLIN
+			|| event & POLLPRI
+			|| event & POLLRDHUP
+			|| event & POLLHUP)
+			revent |= EVENT_READ;
+		if (event & POLLOUT)
+			revent |= EVENT_WRITE;
+		if (event & POLLERR)
+			revent |= EVENT_ERROR;
+
+		idx = direct ? i : RegistryFind(&ep->reg, fd);
+		if (idx < 0) /* poll期间已被删除 */
+			continue;
+
+		item = RegistryAt(&ep->reg, idx);
+		if (item->event & (EVENT_EDGE | EVENT_ONESHOT)) /* 报告后禁用 */
 		{
-			if (event & POLLIN
-				|| event & POLLPRI
-				|| event & POLLRDHUP
-				|| event & POLLHUP)
-				revent |= EVENT_READ;
-			if (event & POLLOUT)
-				revent |= EVENT_WRITE;
-			if (event & POLLERR)
-				revent |= EVENT_ERROR;
-
-			events[real_nums].fd = fd;
-			events[real_nums].retEvent = revent;
-			real_nums++;
-			nums--;
+			revent &= ~item->retEvent; /* 去掉其他线程已经报告过的事件 */
+			if (!revent || ((item->event & EVENT_ONESHOT) && item->retEvent))
+				continue;
+
+			item->retEvent |= (item->event & EVENT_ONESHOT) ? POLL_EVENT_MASK : revent;
+			PollArm(ep, idx);
 		}
+
+		events[real_nums].fd = fd;
+		events[real_nums].retEvent = revent;
+		events[real_nums].userData = item->userData;
+		real_nums++;
 	}
 
+	/* 被maxevents截断时下次从未收集的位置开始，避免后面的fd一直得不到处理 */
+	ep->scanStart = (nums > 0) ? (i + 1) : 0;
+	if (snap)
+		ep->snapBusy = 0;
+
+	EasyUnlock(&ep->lock);
+	StatsBatch(&ep->stats, real_nums);
+
+	if (heap)
+		free(heap);
+
 	return real_nums;
 }
 
+/*
+ * 获取性能计数
+ * handle：Poll句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int PollGetStats(PollHandle handle, PollerStats_t *stats)
+{
+	EasyPoll_t *ep = (EasyPoll_t *)handle;
+	if (!ep || !stats)
+		return -1;
 
+	StatsRead(&ep->stats, stats);
+	stats->lockHeldNs = EasyLockHeldNs(&ep->lock);
+	return 0;
+}
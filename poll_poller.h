@@ -17,11 +17,18 @@ extern "C"
 
 /*
  * 创建Poll监听器
- * size：待监听的文件fd数量
+ * size：预计监听的文件fd数量，超出时自动扩容
  * return：new handle on success，NULL on fail
  */
 PollHandle PollCreate(int size);
 
+/*
+ * 按参数创建Poll监听器
+ * options：创建参数，NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+PollHandle PollCreateEx(const PollerOptions_t *options);
+
 /*
  * 销毁Poll监听器
  * handle：PollCreate()返回的句柄
@@ -46,6 +53,16 @@ int PollWaitEvent(PollHandle handle, EasyEvent_t *events, int maxevents, int tim
  */
 int PollAddEvent(PollHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量添加事件，只加一次锁
+ * handle：Poll句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollAddEvents(PollHandle handle, const EasyEvent_t *events, int count, int *results);
+
 /*
  * 更新事件
  * handle：Poll句柄
@@ -54,6 +71,16 @@ int PollAddEvent(PollHandle handle, const EasyEvent_t *event);
  */
 int PollUpdateEvent(PollHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量更新事件，只加一次锁
+ * handle：Poll句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollUpdateEvents(PollHandle handle, const EasyEvent_t *events, int count, int *results);
+
 /*
  * 删除事件
  * handle：Poll句柄
@@ -62,6 +89,33 @@ int PollUpdateEvent(PollHandle handle, const EasyEvent_t *event);
  */
 int PollRemoveEvent(PollHandle handle, const EasyEvent_t *event);
 
+/*
+ * 批量删除事件，只加一次锁
+ * handle：Poll句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int PollRemoveEvents(PollHandle handle, const EasyEvent_t *events, int count, int *results);
+
+/*
+ * 重新激活事件
+ * EVENT_EDGE/EVENT_ONESHOT事件报告后，按注册时的事件重新激活，无需再传入事件
+ * handle：Poll句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int PollRearmEvent(PollHandle handle, const EasyEvent_t *event);
+
+/*
+ * 获取性能计数
+ * handle：Poll句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int PollGetStats(PollHandle handle, PollerStats_t *stats);
+
 
 
 #ifdef __cplusplus
@@ -7,34 +7,167 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
 #include <sys/select.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include "easy_lock.h"
+#include "easy_registry.h"
+#include "easy_stats.h"
 #include "select_poller.h"
 
+#define SELECT_EVENT_MASK (EVENT_READ | EVENT_WRITE | EVENT_ERROR)
+#define SELECT_WORD_BITS ((int)(8 * sizeof(unsigned long)))
+#define SELECT_MIN_WORDS (FD_SETSIZE / SELECT_WORD_BITS) /* 位图初始字数，与fd_set一样大 */
+#define SELECT_BIT_WORD(fd) ((fd) / SELECT_WORD_BITS)
+#define SELECT_BIT_MASK(fd) (1UL << ((fd) % SELECT_WORD_BITS))
+
 /*
  * SelectHandle具体结构
+ * 3个集合使用按需扩容的位图代替fd_set，因此fd可以大于等于FD_SETSIZE
+ * 3个位图存放在同一块内存中：[read | write | exception]，每个words个字
  */
 typedef struct EasySelect_t
 {
-	int maxFd; /* 最大文件描述符 */
-	fd_set readSet;
-	fd_set writeSet;
-	fd_set exceptionSet;
-	int eventCapacity; /* eventList数组容量 */
-	int eventSize; /* eventList数组当前元素个数 */
-	EasyEvent_t *eventList;
-	pthread_mutex_t mutex;
+	int maxFd; /* 3个集合中的最大文件描述符 */
+	int scanFd; /* 上次返回事件被maxevents截断时，下次从这个fd开始收集 */
+	int words; /* 每个位图的字数 */
+	unsigned long *bits; /* 位图内存 */
+	unsigned long *readBits;
+	unsigned long *writeBits;
+	unsigned long *exceptionBits;
+	EasyRegistry_t reg; /* 已注册的fd */
+	EasyLock_t lock; /* POLLER_FLAG_NOLOCK时不启用 */
+	EasyStats_t stats; /* 性能计数 */
 }EasySelect_t;
 
+/*
+ * 确保位图能容纳fd
+ * return：0 on success，-1 on fail
+ */
+static int SelectReserve(EasySelect_t *ep, int fd)
+{
+	int need = SELECT_BIT_WORD(fd) + 1;
+	if (need <= ep->words)
+		return 0;
+
+	int words = ep->words ? ep->words : SELECT_MIN_WORDS;
+	while (words < need)
+		words <<= 1;
+
+	unsigned long *bits = (unsigned long *)calloc(3 * words, sizeof(unsigned long));
+	if (!bits)
+		return -1;
+
+	if (ep->bits) /* 拷贝原有的3个位图 */
+	{
+		memcpy(bits, ep->readBits, ep->words * sizeof(unsigned long));
+		memcpy(bits + words, ep->writeBits, ep->words * sizeof(unsigned long));
+		memcpy(bits + 2 * words, ep->exceptionBits, ep->words * sizeof(unsigned long));
+		free(ep->bits);
+	}
+
+	ep->bits = bits;
+	ep->readBits = bits;
+	ep->writeBits = bits + words;
+	ep->exceptionBits = bits + 2 * words;
+	ep->words = words;
+	return 0;
+}
+
+/*
+ * 最大fd被清除后，从原最大fd所在的字往低位逐字查找新的最大fd
+ */
+static void SelectLowerMaxFd(EasySelect_t *ep)
+{
+	unsigned long bits = 0;
+	int w = SELECT_BIT_WORD(ep->maxFd);
+
+	for (; w >= 0; w--)
+	{
+		bits = ep->readBits[w] | ep->writeBits[w] | ep->exceptionBits[w];
+		if (bits)
+		{
+			ep->maxFd = w * SELECT_WORD_BITS + (SELECT_WORD_BITS - 1 - __builtin_clzl(bits));
+			return;
+		}
+	}
+
+	ep->maxFd = -1;
+}
+
+/*
+ * 按事件设置fd在3个集合中的状态，并维护最大fd
+ * 设置事件前需要SelectReserve()确保位图能容纳fd
+ */
+static void SelectArm(EasySelect_t *ep, int fd, int event)
+{
+	if (SELECT_BIT_WORD(fd) >= ep->words) /* 从未设置过 */
+		return;
+
+	int w = SELECT_BIT_WORD(fd);
+	unsigned long mask = SELECT_BIT_MASK(fd);
+
+	if (event & EVENT_READ) ep->readBits[w] |= mask;
+	else ep->readBits[w] &= ~mask;
+	if (event & EVENT_WRITE) ep->writeBits[w] |= mask;
+	else ep->writeBits[w] &= ~mask;
+	if (event & EVENT_ERROR) ep->exceptionBits[w] |= mask;
+	else ep->exceptionBits[w] &= ~mask;
+
+	if (event & SELECT_EVENT_MASK)
+	{
+		if (fd > ep->maxFd) /* 更新最大fd */
+			ep->maxFd = fd;
+	}
+	else if (fd == ep->maxFd)
+	{
+		SelectLowerMaxFd(ep);
+	}
+}
+
+/*
+ * 获取fd当前生效的事件
+ */
+static int SelectArmed(EasySelect_t *ep, int fd)
+{
+	if (SELECT_BIT_WORD(fd) >= ep->words)
+		return 0;
+
+	int event = 0, w = SELECT_BIT_WORD(fd);
+	unsigned long mask = SELECT_BIT_MASK(fd);
+
+	if (ep->readBits[w] & mask) event |= EVENT_READ;
+	if (ep->writeBits[w] & mask) event |= EVENT_WRITE;
+	if (ep->exceptionBits[w] & mask) event |= EVENT_ERROR;
+
+	return event;
+}
+
 /*
  * 创建Select监听器
- * size：待监听的文件fd数量
+ * size：预计监听的文件fd数量，超出时自动扩容
  * return：new handle on success，NULL on fail
  */
 SelectHandle SelectCreate(int size)
 {
+	PollerOptions_t options;
+
+	options.size = size;
+	options.flags = 0;
+
+	return SelectCreateEx(&options);
+}
+
+/*
+ * 按参数创建Select监听器
+ * options：创建参数，NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+SelectHandle SelectCreateEx(const PollerOptions_t *options)
+{
+	int size = options ? options->size : 0;
+	int flags = options ? options->flags : 0;
+
 	EasySelect_t *ep = (EasySelect_t *)calloc(1, sizeof(EasySelect_t));
 	if (!ep)
 		return NULL;
@@ -42,16 +175,23 @@ SelectHandle SelectCreate(int size)
 	if (size <= 0)
 		size = 1;
 
-	ep->eventCapacity = size;
-	ep->eventSize = 0;
-	ep->eventList = (EasyEvent_t *)calloc(size, sizeof(EasyEvent_t));
-	if (!ep->eventList)
+	ep->maxFd = -1;
+	if (SelectReserve(ep, 0) < 0)
 	{
 		free(ep);
 		return NULL;
 	}
 
-	pthread_mutex_init(&ep->mutex, NULL);
+	if (RegistryInit(&ep->reg, size) < 0)
+	{
+		free(ep->bits);
+		free(ep);
+		return NULL;
+	}
+
+	EasyLockInit(&ep->lock, !(flags & POLLER_FLAG_NOLOCK));
+	EasyLockTiming(&ep->lock, flags & POLLER_FLAG_STATS_TIME);
+	StatsInit(&ep->stats, options);
 
 	return ep;
 }
@@ -66,11 +206,13 @@ void SelectDestroy(SelectHandle handle)
 	if (!ep)
 		return;
 
-	if (ep->eventList)
-		free(ep->eventList);
-	ep->eventList = NULL;
+	RegistryDestroy(&ep->reg);
+
+	if (ep->bits)
+		free(ep->bits);
+	ep->bits = NULL;
 
-	pthread_mutex_destroy(&ep->mutex);
+	EasyLockDestroy(&ep->lock);
 
 	free(ep);
 }
@@ -87,107 +229,192 @@ int SelectAddEvent(SelectHandle handle, const EasyEvent_t *event)
 }
 
 /*
- * 删除事件
+ * 批量添加事件，只加一次锁
  * handle：Select句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int SelectAddEvents(SelectHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	return SelectUpdateEvents(handle, events, count, results);
+}
+
+/*
+ * 删除事件，调用者已加锁
  * event：待删除事件
  * return：0 on success，-1 on fail
  */
-int SelectRemoveEvent(SelectHandle handle, const EasyEvent_t *event)
+static int SelectRemoveLocked(EasySelect_t *ep, const EasyEvent_t *event)
 {
-	EasySelect_t *ep = (EasySelect_t *)handle;
-	if (!ep || !event || (event->fd < 0))
+	if (!event || (event->fd < 0))
 		return -1;
 
-	pthread_mutex_lock(&ep->mutex);
-
-	EasyEvent_t *eventList = ep->eventList;
 	int fd = event->fd;
-	int idx = 0;
-	
+
 	/* 是否存在该fd */
-	for (; idx < ep->eventSize; idx++)
+	if (RegistryRemove(&ep->reg, fd) >= 0)
 	{
-		if (eventList[idx].fd == fd)
-		{
-			/* 从集合中清理fd */
-			FD_CLR(fd, &ep->readSet);
-			FD_CLR(fd, &ep->writeSet);
-			FD_CLR(fd, &ep->exceptionSet);
-
-			/* 从列表中移除 */
-			memmove(&eventList[idx], &eventList[idx+1], (ep->eventSize - idx - 1) * sizeof(EasyEvent_t));
-			ep->eventSize--;
-			
-			/* 确定最大fd */
-			int i = 0;
-			ep->maxFd = -1;
-			for (; i < ep->eventSize; i++)
-			{
-				if (eventList[i].fd > ep->maxFd)
-					ep->maxFd = eventList[i].fd;
-			}
-			break;
-		}
+		/* 从集合中清理fd，必要时重新确定最大fd */
+		SelectArm(ep, fd, 0);
 	}
 
-	pthread_mutex_unlock(&ep->mutex);
 	return 0;
 }
 
 /*
- * 更新事件
+ * 删除事件
  * handle：Select句柄
- * event：事件
+ * event：待删除事件
  * return：0 on success，-1 on fail
  */
-int SelectUpdateEvent(SelectHandle handle, const EasyEvent_t *event)
+int SelectRemoveEvent(SelectHandle handle, const EasyEvent_t *event)
 {
 	EasySelect_t *ep = (EasySelect_t *)handle;
-	if (!ep || !event || (event->fd < 0))
+	if (!ep)
 		return -1;
 
-	pthread_mutex_lock(&ep->mutex);
+	EasyLock(&ep->lock);
+	int ret = SelectRemoveLocked(ep, event);
+	EasyUnlock(&ep->lock);
 
-	EasyEvent_t *eventList = ep->eventList;
-	int fd = event->fd;
-	int idx = 0;
+	return ret;
+}
 
-	/* 是否已经存在该fd */
-	for (; idx < ep->eventSize; idx++)
+/*
+ * 批量删除事件，只加一次锁
+ * handle：Select句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int SelectRemoveEvents(SelectHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	EasySelect_t *ep = (EasySelect_t *)handle;
+	if (!ep || !events || (count < 0))
+		return -1;
+
+	int i = 0, ret = 0, nums = 0;
+
+	EasyLock(&ep->lock);
+	for (; i < count; i++)
 	{
-		if (eventList[idx].fd == fd)
-			break;
+		ret = SelectRemoveLocked(ep, &events[i]);
+		if (results)
+			results[i] = ret;
+		if (ret == 0)
+			nums++;
 	}
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
 
-	if (idx == ep->eventSize) /* 不存在则添加 */
+/*
+ * 更新事件，调用者已加锁
+ * event：事件
+ * return：0 on success，-1 on fail
+ */
+static int SelectUpdateLocked(EasySelect_t *ep, const EasyEvent_t *event)
+{
+	if (!event || (event->fd < 0))
+		return -1;
+
+	int fd = event->fd;
+	int idx = RegistryFind(&ep->reg, fd); /* 是否已经存在该fd */
+
+	if (idx < 0) /* 不存在则添加 */
 	{
-		if (ep->eventSize >= ep->eventCapacity) /* 已经满了，TODO：扩容 */
+		if (SelectReserve(ep, fd) < 0 || RegistryInsert(&ep->reg, event) < 0) /* 内存不足 */
 		{
-			pthread_mutex_unlock(&ep->mutex);
+			StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
 			return -1;
 		}
-
-		/* 添加到列表中 */
-		memcpy(&eventList[idx], event, sizeof(EasyEvent_t));
-		ep->eventSize++;
 	}
 	else /* 存在则更新 */
 	{
 		/* 更新到列表中 */
-		memcpy(&eventList[idx], event, sizeof(EasyEvent_t));
+		RegistryUpdate(&ep->reg, idx, event);
 	}
 
-	if (event->event & EVENT_READ) FD_SET(fd, &ep->readSet);
-    if (event->event & EVENT_WRITE) FD_SET(fd, &ep->writeSet);
-    if (event->event & EVENT_ERROR) FD_SET(fd, &ep->exceptionSet);
-
-	if (fd > ep->maxFd) /* 更新最大fd */
-		ep->maxFd = fd;
+	SelectArm(ep, fd, event->event);
 
-	pthread_mutex_unlock(&ep->mutex);
 	return 0;
 }
 
+/*
+ * 更新事件
+ * handle：Select句柄
+ * event：事件
+ * return：0 on success，-1 on fail
+ */
+int SelectUpdateEvent(SelectHandle handle, const EasyEvent_t *event)
+{
+	EasySelect_t *ep = (EasySelect_t *)handle;
+	if (!ep)
+		return -1;
+
+	EasyLock(&ep->lock);
+	int ret = SelectUpdateLocked(ep, event);
+	EasyUnlock(&ep->lock);
+
+	return ret;
+}
+
+/*
+ * 批量更新事件，只加一次锁
+ * handle：Select句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int SelectUpdateEvents(SelectHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	EasySelect_t *ep = (EasySelect_t *)handle;
+	if (!ep || !events || (count < 0))
+		return -1;
+
+	int i = 0, ret = 0, nums = 0;
+
+	EasyLock(&ep->lock);
+	for (; i < count; i++)
+	{
+		ret = SelectUpdateLocked(ep, &events[i]);
+		if (results)
+			results[i] = ret;
+		if (ret == 0)
+			nums++;
+	}
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
+
+/*
+ * 重新激活事件
+ * handle：Select句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int SelectRearmEvent(SelectHandle handle, const EasyEvent_t *event)
+{
+	EasySelect_t *ep = (EasySelect_t *)handle;
+	if (!ep || !event || (event->fd < 0))
+		return -1;
+
+	EasyLock(&ep->lock);
+
+	int idx = RegistryFind(&ep->reg, event->fd);
+	if (idx >= 0)
+		SelectArm(ep, event->fd, RegistryAt(&ep->reg, idx)->event);
+
+	EasyUnlock(&ep->lock);
+	return (idx < 0) ? -1 : 0;
+}
+
 /*
  * 监听事件
  * handle：Select句柄
@@ -202,53 +429,138 @@ int SelectWaitEvent(SelectHandle handle, EasyEvent_t *events, int maxevents, int
 	if (!ep || !events || (maxevents < 1))
 		return -1;
 
-	pthread_mutex_lock(&ep->mutex);
+	unsigned long stack[3 * SELECT_MIN_WORDS];
+	unsigned long *heap = NULL, *readWords = stack;
 
-	int ev_size = ep->eventSize;
-	fd_set readSet = ep->readSet;
-	fd_set writeSet = ep->writeSet;
-	fd_set exceptionSet = ep->exceptionSet;
-	EasyEvent_t *eventList = ep->eventList;
-	int max_fd = ep->maxFd;
+	EasyLock(&ep->lock);
 
-	pthread_mutex_unlock(&ep->mutex);
+	int ev_size = ep->reg.eventSize;
+	int max_fd = ep->maxFd;
+	int words = (max_fd < 0) ? 0 : (SELECT_BIT_WORD(max_fd) + 1);
 
-	if (ev_size == 0 || max_fd < 0) /* 没有事件 */
+	if (ev_size == 0) /* 没有事件 */
+	{
+		EasyUnlock(&ep->lock);
 		return 0;
+	}
+
+	if (words > SELECT_MIN_WORDS) /* fd超过FD_SETSIZE，位图放不进栈 */
+	{
+		heap = (unsigned long *)malloc(3 * words * sizeof(unsigned long));
+		if (!heap)
+		{
+			EasyUnlock(&ep->lock);
+			return -1;
+		}
+		readWords = heap;
+	}
+
+	/* 拷贝3个集合，select()只读写前words个字 */
+	unsigned long *writeWords = readWords + words;
+	unsigned long *exceptionWords = readWords + 2 * words;
+	memcpy(readWords, ep->readBits, words * sizeof(unsigned long));
+	memcpy(writeWords, ep->writeBits, words * sizeof(unsigned long));
+	memcpy(exceptionWords, ep->exceptionBits, words * sizeof(unsigned long));
 
-	int ret, revents;
+	EasyUnlock(&ep->lock);
+
+	int ret, revents, armed;
 	struct timeval tv;
 
 	tv.tv_sec = timeout / 1000;
 	tv.tv_usec = (timeout % 1000) * 1000;
 
 	/* 返回3个集合的总事件数 */
-	ret = select(max_fd + 1, &readSet, &writeSet, &exceptionSet, &tv);
+	long long begin = StatsWaitBegin(&ep->stats);
+	ret = select(max_fd + 1, (fd_set *)readWords, (fd_set *)writeWords, (fd_set *)exceptionWords, (timeout < 0) ? NULL : &tv);
+	StatsWaitEnd(&ep->stats, begin);
 	if (ret < 0) /* 出错 */
+	{
+		StatsBatch(&ep->stats, ret);
+		if (heap)
+			free(heap);
 		return -1;
+	}
 
-	pthread_mutex_lock(&ep->mutex);
-	int i = 0, real_nums = 0;
-	for (; i < ev_size; i++)
-	{
-		revents = 0;
-		if (FD_ISSET(eventList[i].fd, &readSet)) revents |= EVENT_READ;
-		if (FD_ISSET(eventList[i].fd, &writeSet)) revents |= EVENT_WRITE;
-		if (FD_ISSET(eventList[i].fd, &exceptionSet)) revents |= EVENT_ERROR;
+	unsigned long bits = 0, mask = 0;
+	EasyEvent_t *item = NULL;
+	int k = 0, w = 0, fd = -1, idx = 0, real_nums = 0;
+
+	EasyLock(&ep->lock);
+
+	/* 逐字扫描返回的集合，只处理置位的fd；从scanFd开始，绕回后处理到scanFd之前 */
+	int start = (ep->scanFd <= max_fd) ? ep->scanFd : 0;
+	int startWord = start / SELECT_WORD_BITS;
+	unsigned long startMask = ~0UL << (start % SELECT_WORD_BITS);
 
-		if (revents) /* 该fd有事件触发 */
+	for (; (k <= words) && (ret > 0) && (real_nums < maxevents); k++)
+	{
+		w = (startWord + k) % words;
+		bits = readWords[w] | writeWords[w] | exceptionWords[w];
+		if (k == 0)
+			bits &= startMask;
+		else if (k == words)
+			bits &= ~startMask;
+
+		while (bits && (real_nums < maxevents))
 		{
-			events[real_nums].fd = eventList[i].fd;
+			mask = bits & -bits; /* 最低置位 */
+			fd = w * SELECT_WORD_BITS + __builtin_ctzl(bits);
+			bits &= bits - 1;
+
+			revents = 0;
+			if (readWords[w] & mask) revents |= EVENT_READ;
+			if (writeWords[w] & mask) revents |= EVENT_WRITE;
+			if (exceptionWords[w] & mask) revents |= EVENT_ERROR;
+			ret -= __builtin_popcount(revents);
+
+			idx = RegistryFind(&ep->reg, fd);
+			if (idx < 0) /* select期间已被删除 */
+				continue;
+
+			item = RegistryAt(&ep->reg, idx);
+			if (item->event & (EVENT_EDGE | EVENT_ONESHOT)) /* 报告后禁用 */
+			{
+				armed = SelectArmed(ep, fd);
+				revents &= armed; /* 去掉其他线程已经报告过的事件 */
+				if (!revents)
+					continue;
+
+				SelectArm(ep, fd, (item->event & EVENT_ONESHOT) ? 0 : (armed & ~revents));
+			}
+
+			events[real_nums].fd = fd;
 			events[real_nums].retEvent = revents;
+			events[real_nums].userData = item->userData;
 			real_nums++;
-			
-			if (real_nums >= maxevents)
-				break;
 		}
 	}
-	pthread_mutex_unlock(&ep->mutex);
+
+	/* 被maxevents截断时下次从下一个fd开始，避免后面的fd一直得不到处理 */
+	ep->scanFd = (ret > 0) ? (fd + 1) : 0;
+
+	EasyUnlock(&ep->lock);
+	StatsBatch(&ep->stats, real_nums);
+
+	if (heap)
+		free(heap);
 
 	return real_nums;
 }
 
+/*
+ * 获取性能计数
+ * handle：Select句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int SelectGetStats(SelectHandle handle, PollerStats_t *stats)
+{
+	EasySelect_t *ep = (EasySelect_t *)handle;
+	if (!ep || !stats)
+		return -1;
 
+	StatsRead(&ep->stats, stats);
+	stats->lockHeldNs = EasyLockHeldNs(&ep->lock);
+	return 0;
+}
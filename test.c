@@ -7,13 +7,14 @@
 
 int main(int argc, char **argv)
 {
-	PollerHandle handle = PollerCreate(PT_EPOLLER, 10); // PT_POLLER PT_SELECTOR
+	PollerHandle handle = PollerCreate(PT_EPOLLER, 10); // PT_POLLER PT_SELECTOR PT_URING
 	LOG("create poll Handle: %p\n", handle);
 	if (handle)
 	{
 		EasyEvent_t event;
 		event.fd = 0; // 标准输入
 		event.event = EVENT_ERROR;
+		event.userData = NULL;
 
 		int ret = PollerAddEvent(handle, &event);
 		LOG("add event ret: %d\n", ret);
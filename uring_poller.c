@@ -0,0 +1,700 @@
+/*
+ * io_uring POLL操作实现
+ * 注册变更只填写SQE，与等待合并为一次io_uring_enter提交，不再有epoll_ctl之类的单独系统调用
+ * EVENT_EDGE使用multishot poll，一次提交持续触发；
+ * 水平触发和EVENT_ONESHOT使用单次poll，触发后(ONESHOT除外)随下次等待重新提交，
+ * 提交时fd仍就绪会立即完成，因此与epoll的水平触发语义一致
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <endian.h>
+#include <poll.h>
+#include "easy_uring.h"
+#include "easy_registry.h"
+#include "easy_stats.h"
+#include "easy_lock.h"
+#include "uring_poller.h"
+
+/*
+ * fd索引项的状态标志(EasyFdEntry_t.state)
+ */
+#define URING_STATE_ARMED 1 /* 内核中有该fd的poll请求，applied为其事件 */
+#define URING_STATE_MULTI 2 /* 当前poll请求为multishot */
+#define URING_STATE_REARM 4 /* 在armList中，收集完完成事件后重新提交 */
+
+#define URING_MIN_ENTRIES 64 /* SQ大小范围 */
+#define URING_MAX_ENTRIES 4096
+#define URING_MAX_CQ_ENTRIES 65536 /* CQ大小上限，超出的完成事件暂存在内核中 */
+
+/* poll请求的user_data：高32位为序号，低32位为fd */
+#define URING_USER_DATA(fd, gen) (((unsigned long long)(gen) << 32) | (unsigned int)(fd))
+#define URING_INTERNAL (~0ULL) /* 内部请求(删除poll)，完成事件直接丢弃 */
+#define URING_PROBE (~0ULL - 1) /* 创建时探测multishot poll的请求 */
+
+/*
+ * UringHandle具体结构
+ */
+typedef struct EasyUring_t
+{
+	EasyIoUring_t ring; /* io_uring队列 */
+	EasyRegistry_t reg; /* 已注册的fd */
+	int *armList; /* 待重新提交poll请求的fd */
+	int armSize; /* armList当前元素个数 */
+	int armCapacity; /* armList数组容量 */
+	EasyLock_t lock; /* POLLER_FLAG_NOLOCK时不启用 */
+	EasyStats_t stats; /* 性能计数 */
+}EasyUring_t;
+
+/*
+ * EVENT_*转换为poll事件
+ */
+static unsigned int UringEvents(int event)
+{
+	unsigned int mask = 0;
+
+	if (event & EVENT_READ)
+		mask |= POLLIN | POLLPRI | POLLRDHUP;
+	if (event & EVENT_WRITE)
+		mask |= POLLOUT;
+
+	return mask;
+}
+
+/*
+ * 提交fd的poll请求，序号加1，之前请求的完成事件都将被丢弃
+ * event：注册的事件
+ * return：0 on success，-1 on fail
+ */
+static int UringArm(EasyUring_t *ep, EasyFdEntry_t *entry, int event)
+{
+	struct io_uring_sqe *sqe = IoUringGetSqe(&ep->ring);
+	if (!sqe)
+		return -1;
+
+	int multi = (event & EVENT_EDGE) && !(event & EVENT_ONESHOT);
+	unsigned int mask = UringEvents(event);
+
+	entry->gen++;
+	entry->applied = mask;
+	entry->state |= URING_STATE_ARMED;
+	if (multi)
+		entry->state |= URING_STATE_MULTI;
+	else
+		entry->state &= ~URING_STATE_MULTI;
+
+#if __BYTE_ORDER == __BIG_ENDIAN
+	mask = (mask << 16) | (mask >> 16); /* poll32_events按小端的两个16位存放 */
+#endif
+
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = entry->fd;
+	sqe->poll32_events = mask;
+	sqe->len = multi ? IORING_POLL_ADD_MULTI : 0;
+	sqe->user_data = URING_USER_DATA(entry->fd, entry->gen);
+
+	return 0;
+}
+
+/*
+ * 撤销fd在内核中的poll请求
+ * return：0 on success，-1 on fail
+ */
+static int UringDisarm(EasyUring_t *ep, EasyFdEntry_t *entry)
+{
+	if (!(entry->state & URING_STATE_ARMED))
+		return 0;
+
+	struct io_uring_sqe *sqe = IoUringGetSqe(&ep->ring);
+	if (!sqe)
+		return -1;
+
+	sqe->opcode = IORING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = URING_USER_DATA(entry->fd, entry->gen);
+	sqe->user_data = URING_INTERNAL;
+	if (ep->ring.features & IORING_FEAT_CQE_SKIP) /* 成功时不产生完成事件 */
+		sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+
+	entry->state &= ~(URING_STATE_ARMED | URING_STATE_MULTI);
+	return 0;
+}
+
+/*
+ * 记录需要重新提交的fd
+ * 收集完成事件期间SQ满了会自动提交，立即提交的poll可能马上完成并在同一次收集中重复报告，
+ * 因此先记下来，收集结束后再提交
+ */
+static void UringDefer(EasyUring_t *ep, EasyFdEntry_t *entry)
+{
+	if (entry->state & URING_STATE_REARM)
+		return;
+
+	if (ep->armSize >= ep->armCapacity) /* 扩容 */
+	{
+		int capacity = ep->armCapacity ? ep->armCapacity * 2 : 64;
+		int *list = (int *)realloc(ep->armList, capacity * sizeof(int));
+		if (!list) /* 内存不足时直接提交 */
+		{
+			UringArm(ep, entry, RegistryAt(&ep->reg, entry->slot)->event);
+			return;
+		}
+
+		ep->armList = list;
+		ep->armCapacity = capacity;
+	}
+
+	ep->armList[ep->armSize++] = entry->fd;
+	entry->state |= URING_STATE_REARM;
+}
+
+/*
+ * 重新提交armList中仍需要的poll请求
+ */
+static void UringRearmDeferred(EasyUring_t *ep)
+{
+	EasyFdEntry_t *entry = NULL;
+	int i = 0;
+
+	for (; i < ep->armSize; i++)
+	{
+		entry = RegistryEntry(&ep->reg, ep->armList[i]);
+		entry->state &= ~URING_STATE_REARM;
+
+		/* 期间已删除或已被更新重新提交的跳过 */
+		if (entry->slot >= 0 && !(entry->state & URING_STATE_ARMED))
+			UringArm(ep, entry, RegistryAt(&ep->reg, entry->slot)->event);
+	}
+
+	ep->armSize = 0;
+}
+
+/*
+ * 创建Uring监听器
+ * size：预计监听的文件fd数量，超出时自动扩容
+ * return：new handle on success，NULL on fail
+ */
+UringHandle UringCreate(int size)
+{
+	PollerOptions_t options;
+
+	options.size = size;
+	options.flags = 0;
+
+	return UringCreateEx(&options);
+}
+
+/*
+ * 探测内核是否支持multishot poll(IORING_POLL_ADD_MULTI，5.13)
+ * 对空管道提交一个multishot poll再立即删除，支持时poll以-ECANCELED结束，否则为-EINVAL
+ * return：0 on success，-1 on fail
+ */
+static int UringProbeMulti(EasyIoUring_t *ring)
+{
+	struct io_uring_sqe *sqe = NULL;
+	struct io_uring_cqe *cqe = NULL;
+	int fds[2], res = -EINVAL, seen = 0;
+
+	if (pipe(fds) < 0)
+		return -1;
+
+	sqe = IoUringGetSqe(ring);
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fds[0];
+#if __BYTE_ORDER == __BIG_ENDIAN
+	sqe->poll32_events = POLLIN << 16;
+#else
+	sqe->poll32_events = POLLIN;
+#endif
+	sqe->len = IORING_POLL_ADD_MULTI;
+	sqe->user_data = URING_PROBE;
+
+	sqe = IoUringGetSqe(ring);
+	sqe->opcode = IORING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = URING_PROBE;
+	sqe->user_data = URING_INTERNAL;
+
+	/* 两个请求都在提交时完成 */
+	if (IoUringWait(ring, IoUringFlush(ring), 2, 1000) == 0)
+	{
+		while (seen < 2 && (cqe = IoUringPeekCqe(ring)) != NULL)
+		{
+			if (cqe->user_data == URING_PROBE)
+				res = cqe->res;
+			IoUringCqeSeen(ring);
+			seen++;
+		}
+	}
+
+	close(fds[0]);
+	close(fds[1]);
+
+	if (seen < 2 || res != -ECANCELED)
+	{
+		errno = ENOSYS;
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * 按参数创建Uring监听器
+ * options：创建参数，NULL表示使用默认参数
+ * return：new handle on success，NULL on fail
+ */
+UringHandle UringCreateEx(const PollerOptions_t *options)
+{
+	int size = options ? options->size : 0;
+	int flags = options ? options->flags : 0;
+	unsigned int entries = URING_MIN_ENTRIES, cq_entries = 0;
+
+	EasyUring_t *ep = (EasyUring_t *)calloc(1, sizeof(EasyUring_t));
+	if (!ep)
+		return NULL;
+
+	if (size <= 0)
+		size = 1;
+
+	/* SQ只需容纳两次等待之间的注册变更，满了会自动提交 */
+	while (entries < (unsigned int)size && entries < URING_MAX_ENTRIES)
+		entries <<= 1;
+
+	/* 每个fd同时最多有一个poll请求，CQ按fd数量分配 */
+	cq_entries = entries * 2;
+	while (cq_entries < (unsigned int)size && cq_entries < URING_MAX_CQ_ENTRIES)
+		cq_entries <<= 1;
+
+	if (IoUringInit(&ep->ring, entries, cq_entries) < 0)
+	{
+		free(ep);
+		return NULL;
+	}
+
+	if (UringProbeMulti(&ep->ring) < 0) /* EVENT_EDGE依赖multishot poll */
+	{
+		IoUringDestroy(&ep->ring);
+		free(ep);
+		return NULL;
+	}
+
+	if (RegistryInit(&ep->reg, size) < 0)
+	{
+		IoUringDestroy(&ep->ring);
+		free(ep);
+		return NULL;
+	}
+
+	EasyLockInit(&ep->lock, !(flags & POLLER_FLAG_NOLOCK));
+	EasyLockTiming(&ep->lock, flags & POLLER_FLAG_STATS_TIME);
+	StatsInit(&ep->stats, options);
+
+	return ep;
+}
+
+/*
+ * 销毁Uring监听器
+ * handle：UringCreate()返回的句柄
+ */
+void UringDestroy(UringHandle handle)
+{
+	EasyUring_t *ep = (EasyUring_t *)handle;
+	if (!ep)
+		return;
+
+	IoUringDestroy(&ep->ring); /* 关闭io_uring时内核取消全部poll请求 */
+
+	RegistryDestroy(&ep->reg);
+
+	if (ep->armList)
+		free(ep->armList);
+	ep->armList = NULL;
+
+	EasyLockDestroy(&ep->lock);
+
+	free(ep);
+}
+
+/*
+ * 删除事件，调用者已加锁
+ * event：待删除事件
+ * return：0 on success，-1 on fail
+ */
+static int UringRemoveLocked(EasyUring_t *ep, const EasyEvent_t *event)
+{
+	if (!event || (event->fd < 0))
+		return -1;
+
+	int fd = event->fd;
+
+	/* 是否存在该fd */
+	if (RegistryFind(&ep->reg, fd) >= 0)
+	{
+		if (UringDisarm(ep, RegistryEntry(&ep->reg, fd)) < 0)
+			return -1;
+
+		/* 从列表中移除 */
+		RegistryRemove(&ep->reg, fd);
+	}
+
+	return 0;
+}
+
+/*
+ * 删除事件
+ * handle：Uring句柄
+ * event：待删除事件
+ * return：0 on success，-1 on fail
+ */
+int UringRemoveEvent(UringHandle handle, const EasyEvent_t *event)
+{
+	EasyUring_t *ep = (EasyUring_t *)handle;
+	if (!ep)
+		return -1;
+
+	EasyLock(&ep->lock);
+	int ret = UringRemoveLocked(ep, event);
+	EasyUnlock(&ep->lock);
+
+	return ret;
+}
+
+/*
+ * 批量删除事件，只加一次锁
+ * handle：Uring句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int UringRemoveEvents(UringHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	EasyUring_t *ep = (EasyUring_t *)handle;
+	if (!ep || !events || (count < 0))
+		return -1;
+
+	int i = 0, ret = 0, nums = 0;
+
+	EasyLock(&ep->lock);
+	for (; i < count; i++)
+	{
+		ret = UringRemoveLocked(ep, &events[i]);
+		if (results)
+			results[i] = ret;
+		if (ret == 0)
+			nums++;
+	}
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
+
+/*
+ * 更新事件，调用者已加锁
+ * event：事件
+ * return：0 on success，-1 on fail
+ */
+static int UringUpdateLocked(EasyUring_t *ep, const EasyEvent_t *event)
+{
+	if (!event || (event->fd < 0))
+		return -1;
+
+	int fd = event->fd;
+	int idx = RegistryFind(&ep->reg, fd); /* 是否已经存在该fd */
+
+	if (idx < 0) /* 不存在则添加 */
+	{
+		if (RegistryInsert(&ep->reg, event) < 0)
+		{
+			StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
+			return -1;
+		}
+
+		if (UringArm(ep, RegistryEntry(&ep->reg, fd), event->event) < 0)
+		{
+			StatsAdd(&ep->stats, &ep->stats.s.addFailures, 1);
+			RegistryRemove(&ep->reg, fd);
+			return -1;
+		}
+
+		return 0;
+	}
+
+	EasyFdEntry_t *entry = RegistryEntry(&ep->reg, fd);
+	int multi = (event->event & EVENT_EDGE) && !(event->event & EVENT_ONESHOT);
+
+	/* 更新到列表中 */
+	RegistryUpdate(&ep->reg, idx, event);
+
+	/* 内核中的poll请求不变时无需重新提交 */
+	if ((entry->state & URING_STATE_ARMED)
+		&& entry->applied == UringEvents(event->event)
+		&& !(entry->state & URING_STATE_MULTI) == !multi)
+		return 0;
+
+	if (UringDisarm(ep, entry) < 0 || UringArm(ep, entry, event->event) < 0)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * 更新事件
+ * handle：Uring句柄
+ * event：事件
+ * return：0 on success，-1 on fail
+ */
+int UringUpdateEvent(UringHandle handle, const EasyEvent_t *event)
+{
+	EasyUring_t *ep = (EasyUring_t *)handle;
+	if (!ep)
+		return -1;
+
+	EasyLock(&ep->lock);
+	int ret = UringUpdateLocked(ep, event);
+	EasyUnlock(&ep->lock);
+
+	return ret;
+}
+
+/*
+ * 批量更新事件，只加一次锁
+ * handle：Uring句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int UringUpdateEvents(UringHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	EasyUring_t *ep = (EasyUring_t *)handle;
+	if (!ep || !events || (count < 0))
+		return -1;
+
+	int i = 0, ret = 0, nums = 0;
+
+	EasyLock(&ep->lock);
+	for (; i < count; i++)
+	{
+		ret = UringUpdateLocked(ep, &events[i]);
+		if (results)
+			results[i] = ret;
+		if (ret == 0)
+			nums++;
+	}
+	EasyUnlock(&ep->lock);
+
+	return nums;
+}
+
+/*
+ * 添加事件
+ * handle：Uring句柄
+ * event：待添加事件
+ * return：0 on success，-1 on fail
+ */
+int UringAddEvent(UringHandle handle, const EasyEvent_t *event)
+{
+	return UringUpdateEvent(handle, event);
+}
+
+/*
+ * 批量添加事件，只加一次锁
+ * handle：Uring句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int UringAddEvents(UringHandle handle, const EasyEvent_t *events, int count, int *results)
+{
+	return UringUpdateEvents(handle, events, count, results);
+}
+
+/*
+ * 重新激活事件
+ * 重新提交poll请求，fd仍就绪时会再次报告
+ * handle：Uring句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int UringRearmEvent(UringHandle handle, const EasyEvent_t *event)
+{
+	EasyUring_t *ep = (EasyUring_t *)handle;
+	if (!ep || !event || (event->fd < 0))
+		return -1;
+
+	int ret = -1;
+
+	EasyLock(&ep->lock);
+
+	int idx = RegistryFind(&ep->reg, event->fd);
+	if (idx >= 0)
+	{
+		EasyFdEntry_t *entry = RegistryEntry(&ep->reg, event->fd);
+		if (UringDisarm(ep, entry) == 0 && UringArm(ep, entry, RegistryAt(&ep->reg, idx)->event) == 0)
+			ret = 0;
+	}
+
+	EasyUnlock(&ep->lock);
+	return ret;
+}
+
+/*
+ * 监听事件
+ * 积累的注册变更与等待合并为一次io_uring_enter，系统调用期间不持有锁
+ * 完成事件超过maxevents时剩余的留在CQ中，下次返回
+ * handle：Uring句柄
+ * events：保存触发的事件数组
+ * maxevents：events数组大小
+ * timeout：超时时间(ms)
+ * return：返回实际的事件个数，失败返回-1
+ */
+int UringWaitEvent(UringHandle handle, EasyEvent_t *events, int maxevents, int timeout)
+{
+	EasyUring_t *ep = (EasyUring_t *)handle;
+	if (!ep || !events || (maxevents < 1))
+		return -1;
+
+	struct io_uring_cqe *cqe = NULL;
+	EasyFdEntry_t *entry = NULL;
+	EasyEvent_t *item = NULL;
+	unsigned long long data = 0;
+	unsigned int flags = 0;
+	int real_nums = 0, fd = -1, res = 0, revent = 0, ev_size = 0, ready = 0, retry = 0;
+	unsigned int submit = 0;
+	long long start = (timeout > 0) ? StatsNow() : 0, elapsed = 0;
+	int remain = timeout;
+
+again:
+	EasyLock(&ep->lock);
+	ev_size = ep->reg.eventSize;
+	ready = (IoUringPeekCqe(&ep->ring) != NULL); /* 已有未取走的完成事件时不再等待 */
+	submit = IoUringFlush(&ep->ring);
+	EasyUnlock(&ep->lock);
+
+	if (ev_size == 0 && !ready) /* 没有事件，只提交删除请求 */
+	{
+		IoUringWait(&ep->ring, submit, 0, 0);
+		return 0;
+	}
+
+	long long begin = StatsWaitBegin(&ep->stats);
+	res = IoUringWait(&ep->ring, submit, ready ? 0 : 1, remain);
+	if (!retry)
+		StatsWaitEnd(&ep->stats, begin);
+	else if (ep->stats.timing) /* 重新等待只累计阻塞时间，仍算一次等待 */
+		StatsAdd(&ep->stats, &ep->stats.s.blockedNs, StatsNow() - begin);
+	if (res < 0) /* 出错 */
+	{
+		StatsBatch(&ep->stats, res);
+		return -1;
+	}
+
+	EasyLock(&ep->lock);
+
+	for (;;)
+	{
+		cqe = IoUringPeekCqe(&ep->ring);
+		if (!cqe)
+		{
+			/* CQ已取空，取回内核中溢出的完成事件 */
+			if (real_nums >= maxevents || !IoUringOverflow(&ep->ring) || IoUringReap(&ep->ring) < 0)
+				break;
+			continue;
+		}
+
+		if (real_nums >= maxevents)
+			break;
+
+		data = cqe->user_data;
+		res = cqe->res;
+		flags = cqe->flags;
+		IoUringCqeSeen(&ep->ring);
+
+		if (data == URING_INTERNAL)
+			continue;
+
+		fd = (int)(unsigned int)data;
+		entry = RegistryEntry(&ep->reg, fd);
+		if (!entry || entry->slot < 0 || entry->gen != (unsigned int)(data >> 32)) /* 已删除或已重新提交 */
+			continue;
+
+		item = RegistryAt(&ep->reg, entry->slot);
+
+		if (!(flags & IORING_CQE_F_MORE)) /* poll请求已结束 */
+		{
+			entry->state &= ~(URING_STATE_ARMED | URING_STATE_MULTI);
+
+			/* 单次poll或被内核终止的multishot poll重新提交，随下次等待进入内核；出错的fd不再提交 */
+			if (res >= 0 && !(item->event & EVENT_ONESHOT))
+				UringDefer(ep, entry);
+		}
+
+		revent = 0;
+		if (res < 0)
+		{
+			if (res == -ECANCELED)
+				continue;
+			revent = EVENT_ERROR;
+		}
+		else
+		{
+			if (res & POLLIN
+				|| res & POLLPRI
+				|| res & POLLRDHUP
+				|| res & POLLHUP)
+				revent |= EVENT_READ;
+			if (res & POLLOUT)
+				revent |= EVENT_WRITE;
+			if (res & POLLERR)
+				revent |= EVENT_ERROR;
+		}
+
+		events[real_nums].fd = fd;
+		events[real_nums].retEvent = revent;
+		events[real_nums].userData = entry->userData;
+		real_nums++;
+	}
+
+	UringRearmDeferred(ep);
+
+	EasyUnlock(&ep->lock);
+
+	if (real_nums == 0 && ready) /* 未等待就取到的完成事件都已失效，重新等待，扣除已用的时间 */
+	{
+		if (timeout > 0)
+		{
+			elapsed = (StatsNow() - start) / 1000000;
+			remain = (elapsed < timeout) ? (int)(timeout - elapsed) : 0;
+		}
+		retry = 1;
+		goto again;
+	}
+
+	StatsBatch(&ep->stats, real_nums);
+	return real_nums;
+}
+
+/*
+ * 获取性能计数
+ * handle：Uring句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int UringGetStats(UringHandle handle, PollerStats_t *stats)
+{
+	EasyUring_t *ep = (EasyUring_t *)handle;
+	if (!ep || !stats)
+		return -1;
+
+	StatsRead(&ep->stats, stats);
+	stats->lockHeldNs = EasyLockHeldNs(&ep->lock);
+	return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * io_uring POLL操作声明
+ * Copyright FreeCode. All Rights Reserved.
+ * MIT License (https://opensource.org/licenses/MIT)
+ * 2025 by liuqingshuige
+ */
+#ifndef __FREE_EASY_URING_POLLER_H__
+#define __FREE_EASY_URING_POLLER_H__
+#include "easy_event.h"
+
+typedef void *UringHandle;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * 创建Uring监听器
+ * size：预计监听的文件fd数量，超出时自动扩容
+ * return：new handle on success，NULL on fail(内核不支持io_uring或已被禁用)
+ */
+UringHandle UringCreate(int size);
+
+/*
+ * 按参数创建Uring监听器
+ * options：创建参数，NULL表示使用默认参数，POLLER_FLAG_CHANGELIST对io_uring无影响(变更总是随等待提交)
+ * return：new handle on success，NULL on fail
+ */
+UringHandle UringCreateEx(const PollerOptions_t *options);
+
+/*
+ * 销毁Uring监听器
+ * 内核回收io_uring时可能打断当前线程随后的一次阻塞调用(返回EINTR)
+ * handle：UringCreate()返回的句柄
+ */
+void UringDestroy(UringHandle handle);
+
+/*
+ * 监听事件
+ * handle：Uring句柄
+ * events：保存触发的事件数组
+ * maxevents：events数组大小
+ * timeout：超时时间(ms)
+ * return：返回实际的事件个数，失败返回-1
+ */
+int UringWaitEvent(UringHandle handle, EasyEvent_t *events, int maxevents, int timeout);
+
+/*
+ * 添加事件
+ * handle：Uring句柄
+ * event：待添加事件
+ * return：0 on success，-1 on fail
+ */
+int UringAddEvent(UringHandle handle, const EasyEvent_t *event);
+
+/*
+ * 批量添加事件，只加一次锁
+ * handle：Uring句柄
+ * events：待添加事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int UringAddEvents(UringHandle handle, const EasyEvent_t *events, int count, int *results);
+
+/*
+ * 更新事件
+ * handle：Uring句柄
+ * event：事件
+ * return：0 on success，-1 on fail
+ */
+int UringUpdateEvent(UringHandle handle, const EasyEvent_t *event);
+
+/*
+ * 批量更新事件，只加一次锁
+ * handle：Uring句柄
+ * events：事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int UringUpdateEvents(UringHandle handle, const EasyEvent_t *events, int count, int *results);
+
+/*
+ * 删除事件
+ * handle：Uring句柄
+ * event：待删除事件
+ * return：0 on success，-1 on fail
+ */
+int UringRemoveEvent(UringHandle handle, const EasyEvent_t *event);
+
+/*
+ * 批量删除事件，只加一次锁
+ * handle：Uring句柄
+ * events：待删除事件数组
+ * count：events数组大小
+ * results：保存每个事件的结果(0 on success，-1 on fail)，可以为NULL
+ * return：成功的个数，参数错误返回-1
+ */
+int UringRemoveEvents(UringHandle handle, const EasyEvent_t *events, int count, int *results);
+
+/*
+ * 重新激活事件
+ * EVENT_EDGE/EVENT_ONESHOT事件报告后，按注册时的事件重新提交poll请求，无需再传入事件
+ * handle：Uring句柄
+ * event：事件，只使用fd
+ * return：0 on success，-1 on fail
+ */
+int UringRearmEvent(UringHandle handle, const EasyEvent_t *event);
+
+/*
+ * 获取性能计数
+ * handle：Uring句柄
+ * stats：保存计数
+ * return：0 on success，-1 on fail
+ */
+int UringGetStats(UringHandle handle, PollerStats_t *stats);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif